@@ -0,0 +1,59 @@
+/**
+ * @file AgentStore.cpp
+ * @brief The AgentStore class implementation file.
+ */
+
+#include "AgentStore.h"
+
+using namespace std;
+
+/**
+ * @brief The AgentStore class constructor.
+ * The store starts out empty.
+ */
+AgentStore::AgentStore() {
+    // Nothing to do
+}
+
+
+/**
+ * @brief Reserves room in every array so that adding agents never reallocates.
+ * @param[in] capacity The largest number of agents the store will hold.
+ */
+void AgentStore::reserve(int capacity) {
+    row.reserve(capacity);
+    col.reserve(capacity);
+    infected.reserve(capacity);
+    role.reserve(capacity);
+    progress.reserve(capacity);
+    health.reserve(capacity);
+}
+
+
+/**
+ * @brief Appends a new agent to the end of every array.
+ * @param[in] initRow The agent's initial row.
+ * @param[in] initCol The agent's initial column.
+ * @param[in] initInfected Whether the agent is initially infected.
+ * @param[in] initRole The agent's initial role.
+ * @return The id of the new agent.
+ */
+int AgentStore::add(int initRow, int initCol, bool initInfected, AgentRole initRole) {
+    row.push_back(initRow);
+    col.push_back(initCol);
+    infected.push_back(initInfected);
+    role.push_back(initRole);
+    progress.push_back(0);
+    health.push_back(0);
+
+    return int(row.size())-1;
+}
+
+
+/**
+ * @brief Reports how many agents are in the store.
+ * @return The number of agents.
+ */
+int AgentStore::size() {
+    return int(row.size());
+}
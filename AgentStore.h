@@ -0,0 +1,67 @@
+/**
+ * @file AgentStore.h
+ * @brief The AgentStore class declaration file.
+ */
+
+#ifndef AGENTSTORE_H
+#define AGENTSTORE_H
+
+#include <vector>
+
+using namespace std;
+
+/**
+ * @brief The roles an agent can have. Stored in AgentStore::role.
+ */
+enum AgentRole { ROLE_HUMAN, ROLE_DOCTOR, ROLE_SCAVENGER };
+
+/**
+ * @brief Bits stored in AgentStore::progress to track how far a scavenger has gotten.
+ */
+enum ScavengerProgress {
+    REACHED_GATE = 1,
+    HAS_FIRST_INGREDIENT = 2,
+    HAS_SECOND_INGREDIENT = 4,
+    REACHED_RESEARCH_FACILITY = 8
+};
+
+/**
+ * @brief The goal points a scavenger walks to, in the order it visits them. Each has its own distance field on the Board.
+ */
+enum ScavengerGoal {
+    GOAL_GATE,
+    GOAL_FIRST_INGREDIENT,
+    GOAL_SECOND_INGREDIENT,
+    GOAL_RESEARCH_FACILITY,
+    NUM_GOALS
+};
+
+/**
+ * @class AgentStore
+ * @brief Structure-of-arrays storage for every agent on a board.
+ * Agent "id" is the index into each of the parallel arrays, so per-tick loops can walk them linearly.
+ * Human and Scavenger objects are thin views that read and write an agent's entries here; a doctor is moved through a Human view.
+ */
+class AgentStore {
+    public:
+    AgentStore();
+
+    //Reserve room for "capacity" agents so the arrays never reallocate.
+    void reserve(int capacity);
+
+    //Append an agent and return its id.
+    int add(int initRow, int initCol, bool initInfected, AgentRole initRole);
+
+    //Number of agents in the store.
+    int size();
+
+    //Parallel arrays, indexed by agent id.
+    vector<int> row;                    // Board row
+    vector<int> col;                    // Board column
+    vector<unsigned char> infected;     // Nonzero if infected
+    vector<unsigned char> role;         // An AgentRole value
+    vector<unsigned char> progress;     // ScavengerProgress bits (scavengers only)
+    vector<unsigned char> health;       // Health in percent (scavengers only)
+};
+
+#endif // AGENTSTORE_H
@@ -0,0 +1,393 @@
+/**
+ * @file Benchmark.cpp
+ * @brief Microbenchmarks for the hot paths of the simulation. Built and run by "make bench".
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <fcntl.h>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "Board.h"
+#include "DensityBoard.h"
+
+using namespace std;
+
+//Each measurement repeats its operation until at least this much time has passed.
+static const double MIN_SECONDS = 0.2;
+
+//Number of precomputed random inputs cycled through by the lookup benchmarks. A power of two.
+static const int NUM_INPUTS = 4096;
+
+
+/**
+ * @brief A board size and population to measure.
+ */
+struct Scenario {
+    int numRows;
+    int numCols;
+    int numHumans;
+    int numDoctors;
+};
+
+/**
+ * @brief The result of one measurement.
+ */
+struct Measurement {
+    string name;            // What was measured
+    Scenario scenario;      // On which board
+    double nsPerOp;         // Nanoseconds per operation
+    long ops;               // Operations timed
+};
+
+
+/**
+ * @class BenchBoard
+ * @brief A Board that lets the benchmarks call its protected pieces one at a time.
+ */
+class BenchBoard : public Board {
+    public:
+    BenchBoard(const Scenario& scenario) : Board(scenario.numRows, scenario.numCols, scenario.numHumans, scenario.numDoctors) {
+        setHeadless(true);
+    }
+
+    //Fill the landscape and place the humans, as run() does before the first time unit.
+    void prepare(uint64_t seed) {
+        setSeed(seed);
+        setUp();
+    }
+
+    //Advance one time unit, as one iteration of run()'s loop does.
+    void advance() {
+        tick();
+        currentTime++;
+    }
+
+    void infect() {
+        processInfection();
+    }
+
+    //Infect and heal with the bitboard rule.
+    void infectOnBitboards() {
+        setBitboardInfection(true);
+        processInfection();
+        setBitboardInfection(false);
+    }
+
+    bool adjacent(int first, int second) {
+        return isNextTo(first, second);
+    }
+
+    //Turn the first healthy regular human into a scavenger. Returns its id, or -1 if there is none.
+    int makeScavenger() {
+        for (int id=0; id<numHumans; id++) {
+            if (agents.role[id] == ROLE_HUMAN && ! agents.infected[id]) {
+                changeRole(id, ROLE_SCAVENGER);
+                buildGoalFields();
+                return id;
+            }
+        }
+        return -1;
+    }
+
+    //Choose (but do not make) one path-finding move of scavenger "id" toward goal "goal".
+    void pathFind(int id, ScavengerGoal goal, Random& dice) {
+        int row = agents.row[id];
+        int col = agents.col[id];
+        scavengers[scavengerIndex(id)].doPathFindingMove(dice, goal, row, col);
+    }
+
+    //Open and close the city gate, repairing the goal distance fields after each.
+    void toggleGate() {
+        openCityGate();
+        updateGoalFields();
+        closeCityGate();
+        updateGoalFields();
+    }
+
+    //Size the frames as run() does for a board that is not headless.
+    void prepareScreen() {
+        int screenRows = numRows+STATISTICS_ROWS;
+        int screenCols = (numCols > STATISTICS_COLS) ? numCols : STATISTICS_COLS;
+        screen.resize(screenRows, screenCols);
+        display.resize(screenRows, screenCols);
+        frames.resize(screen.size());
+    }
+
+    //Draw the current time unit into a frame and publish it.
+    void draw() {
+        drawFrame();
+    }
+
+    //Send the last published frame to the terminal, as the render thread does.
+    void present() {
+        if (frames.acquire()) {
+            display.swapBack(frames.readSlot());
+        }
+        display.present();
+    }
+
+    int size() {
+        return numHumans;
+    }
+};
+
+
+/**
+ * @class DensityBenchBoard
+ * @brief A DensityBoard that lets the benchmarks set it up and advance it one time unit at a time.
+ */
+class DensityBenchBoard : public DensityBoard {
+    public:
+    DensityBenchBoard(const Scenario& scenario) : DensityBoard(scenario.numRows, scenario.numCols, scenario.numHumans, scenario.numDoctors) {
+    }
+
+    //Fill the landscape and spread the people, as run() does before the first time unit.
+    void prepare(uint64_t seed) {
+        setSeed(seed);
+        setUp();
+    }
+
+    //Advance one time unit, as one iteration of run()'s loop does.
+    void advance() {
+        tick();
+        currentTime++;
+    }
+};
+
+
+/**
+ * @brief Times an operation by running it in batches of doubling size until MIN_SECONDS have passed.
+ * @param[in] body Runs the operation a given number of times.
+ * @param[out] ops The number of operations timed.
+ * @return Nanoseconds per operation.
+ */
+template <typename Body>
+static double timeOps(Body body, long& ops) {
+    long batch = 1;
+    ops = 0;
+    double seconds = 0;
+
+    while (seconds < MIN_SECONDS) {
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        body(batch);
+        seconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        ops += batch;
+        batch *= 2;
+    }
+    return seconds*1e9 / ops;
+}
+
+
+/**
+ * @brief Records a measurement.
+ * @param[out] results Where to add it.
+ * @param[in] name What was measured.
+ * @param[in] scenario On which board.
+ * @param[in] nsPerOp Nanoseconds per operation.
+ * @param[in] ops Operations timed.
+ */
+static void record(vector<Measurement>& results, const string& name, const Scenario& scenario, double nsPerOp, long ops) {
+    Measurement measurement;
+    measurement.name = name;
+    measurement.scenario = scenario;
+    measurement.nsPerOp = nsPerOp;
+    measurement.ops = ops;
+    results.push_back(measurement);
+}
+
+
+/**
+ * @brief Measures every hot path on one scenario.
+ * Board::tryMove, Board::isNextTo, Board::processInfection (with either rule), Scavenger::doPathFindingMove, repairing the goal distance fields,
+ * drawing a frame, and presenting it are measured on one prepared board; whole time units on a fresh one, from the start of the game,
+ * and again on a fresh DensityBoard.
+ * @param[out] results Where to add the measurements.
+ * @param[in] scenario The board to measure on.
+ * @param[in] maxTicks The most time units to measure, so large boards finish in reasonable time.
+ */
+static void benchScenario(vector<Measurement>& results, const Scenario& scenario, int maxTicks) {
+    BenchBoard board(scenario);
+    board.prepare(1);
+    Random dice(2);
+    long ops;
+    double ns;
+
+    //Keeps the compiler from dropping the results of the lookups.
+    volatile long sink = 0;
+
+    //Board::tryMove, on random cells including a margin off the board.
+    vector<int> rows(NUM_INPUTS), cols(NUM_INPUTS);
+    for (int i=0; i<NUM_INPUTS; i++) {
+        rows[i] = dice.nextInt() % (scenario.numRows+4) - 2;
+        cols[i] = dice.nextInt() % (scenario.numCols+4) - 2;
+    }
+    ns = timeOps([&](long count) {
+        long allowed = 0;
+        for (long i=0; i<count; i++) {
+            allowed += board.tryMove(rows[i & (NUM_INPUTS-1)], cols[i & (NUM_INPUTS-1)]);
+        }
+        sink += allowed;
+    }, ops);
+    record(results, "tryMove", scenario, ns, ops);
+
+    //Board::isNextTo, on random pairs of humans.
+    vector<int> firsts(NUM_INPUTS), seconds(NUM_INPUTS);
+    for (int i=0; i<NUM_INPUTS; i++) {
+        firsts[i] = dice.nextInt() % board.size();
+        seconds[i] = dice.nextInt() % board.size();
+    }
+    ns = timeOps([&](long count) {
+        long adjacent = 0;
+        for (long i=0; i<count; i++) {
+            adjacent += board.adjacent(firsts[i & (NUM_INPUTS-1)], seconds[i & (NUM_INPUTS-1)]);
+        }
+        sink += adjacent;
+    }, ops);
+    record(results, "isNextTo", scenario, ns, ops);
+
+    //Board::processInfection, one call per operation.
+    ns = timeOps([&](long count) {
+        for (long i=0; i<count; i++) {
+            board.infect();
+        }
+    }, ops);
+    record(results, "processInfection", scenario, ns, ops);
+
+    //Board::processInfection with the bitboard rule, one call per operation.
+    ns = timeOps([&](long count) {
+        for (long i=0; i<count; i++) {
+            board.infectOnBitboards();
+        }
+    }, ops);
+    record(results, "processInfectionBitboard", scenario, ns, ops);
+
+    //Scavenger::doPathFindingMove, cycling through the four goals.
+    int scavenger = board.makeScavenger();
+    if (scavenger >= 0) {
+        ns = timeOps([&](long count) {
+            for (long i=0; i<count; i++) {
+                board.pathFind(scavenger, ScavengerGoal(i % NUM_GOALS), dice);
+            }
+        }, ops);
+        record(results, "doPathFindingMove", scenario, ns, ops);
+
+        //Board::updateGoalFields, once after opening the gate and once after closing it.
+        ns = timeOps([&](long count) {
+            for (long i=0; i<count; i++) {
+                board.toggleGate();
+            }
+        }, ops);
+        record(results, "toggleGate", scenario, ns, ops);
+    }
+
+    //Drawing a frame, and presenting it after a time unit has changed the board. The terminal output goes to /dev/null.
+    board.prepareScreen();
+    ns = timeOps([&](long count) {
+        for (long i=0; i<count; i++) {
+            board.draw();
+        }
+    }, ops);
+    record(results, "drawFrame", scenario, ns, ops);
+
+    cout.flush();
+    int savedOut = dup(STDOUT_FILENO);
+    int nullOut = open("/dev/null", O_WRONLY);
+    dup2(nullOut, STDOUT_FILENO);
+
+    double presentSeconds = 0;
+    long presents = 0;
+    while (presentSeconds < MIN_SECONDS && presents < maxTicks) {
+        board.advance();
+        board.draw();
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        board.present();
+        presentSeconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        presents++;
+    }
+
+    dup2(savedOut, STDOUT_FILENO);
+    close(nullOut);
+    close(savedOut);
+    record(results, "present", scenario, presentSeconds*1e9 / presents, presents);
+
+    //Whole time units from the start of a game.
+    BenchBoard game(scenario);
+    game.prepare(3);
+    double tickSeconds = 0;
+    long ticks = 0;
+    while (tickSeconds < MIN_SECONDS && ticks < maxTicks) {
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        game.advance();
+        tickSeconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        ticks++;
+    }
+    record(results, "tick", scenario, tickSeconds*1e9 / ticks, ticks);
+
+    //Whole time units of the same scenario on densities.
+    DensityBenchBoard field(scenario);
+    field.prepare(3);
+    tickSeconds = 0;
+    ticks = 0;
+    while (tickSeconds < MIN_SECONDS && ticks < maxTicks) {
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        field.advance();
+        tickSeconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        ticks++;
+    }
+    record(results, "densityTick", scenario, tickSeconds*1e9 / ticks, ticks);
+}
+
+
+/**
+ * @brief Prints the measurements as one line of JSON.
+ * Every measurement has its name, board, nanoseconds per operation, and number of operations timed.
+ * Whole time units (of both kinds of board) also report ticks per second.
+ * @param[out] out The stream to print to.
+ * @param[in] results The measurements.
+ */
+static void printResults(ostream& out, const vector<Measurement>& results) {
+    out << "{\"benchmarks\":[";
+    for (size_t i=0; i<results.size(); i++) {
+        const Measurement& m = results[i];
+        out << (i > 0 ? "," : "")
+            << "{\"name\":\"" << m.name << "\""
+            << ",\"rows\":" << m.scenario.numRows
+            << ",\"cols\":" << m.scenario.numCols
+            << ",\"humans\":" << m.scenario.numHumans
+            << ",\"nsPerOp\":" << m.nsPerOp
+            << ",\"ops\":" << m.ops;
+        if (m.name == "tick" || m.name == "densityTick") {
+            out << ",\"ticksPerSecond\":" << 1e9 / m.nsPerOp;
+        }
+        out << "}";
+    }
+    out << "]}" << endl;
+}
+
+
+/**
+ * @fn main()
+ * @brief Runs every benchmark on populations of 18, 1,000, and 100,000 humans, on small and large boards, and prints the results as JSON.
+ **/
+int main() {
+    Scenario scenarios[] = {
+        {20, 80, 18, 2},
+        {200, 800, 18, 2},
+        {100, 300, 1000, 20},
+        {400, 1000, 100000, 100},
+        {1000, 2500, 100000, 100}
+    };
+    int maxTicks[] = {400, 400, 400, 20, 20};
+
+    vector<Measurement> results;
+    for (size_t s=0; s<sizeof(scenarios)/sizeof(scenarios[0]); s++) {
+        benchScenario(results, scenarios[s], maxTicks[s]);
+    }
+
+    printResults(cout, results);
+    return 0;
+}
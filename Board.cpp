@@ -7,16 +7,19 @@
  * @date May 2019
  */
 
+#include <algorithm>
+#include <cassert>
 #include <iostream>
 #include <cstdlib>
 #include <unistd.h>
 #include <string>
+#include <sstream>
+#include <thread>
+#include <chrono>
 
 // When writing a class implementation file, you must "#include" the class
 // declaration file.
 #include "Board.h"
-#include "Doctor.h"
-#include "Scavenger.h"
 
 // We also use the conio namespace contents, so must "#include" the conio declarations.
 #include "conio.h"
@@ -41,7 +44,7 @@
  * @param numberOfHumans The number of humans to place on the board.
  * @param numberOfDoctors The number of doctors to place on the board.
  */
-Board::Board(int rows, int cols, int numberOfHumans, int numberOfDoctors) {
+Board::Board(int rows, int cols, int numberOfHumans, int numberOfDoctors) : neighborGrid(rows, cols), infectionBitboard(rows, cols) {
     //Initialize from parameters.
     numHumans = numberOfHumans;
     numDoctors = numberOfDoctors;
@@ -51,15 +54,37 @@ Board::Board(int rows, int cols, int numberOfHumans, int numberOfDoctors) {
     //Initialize time variables.
     currentTime = 0;
     uSleepTime = 250000;
+    frameInterval = 1000000/30;
+    tickLimit = 400;
+    timeToStopAt = -1;
+    outcomeDecided = false;
+    decidedReason = REASON_TIME_LIMIT;
+    decidedTime = -1;
+
+    //Draw to the screen unless told otherwise.
+    headless = false;
+    moveThreads = 0;
+    bitboardInfection = false;
+
+    //Start a new game, and never write checkpoints, unless told otherwise.
+    startingSeed = 0;
+    restored = false;
+    checkpointInterval = 0;
+    traceKeyframeInterval = 0;
 
     //Initialize number of infected.
     numInfected=0;
 
+    //The goal distance fields are built when the first scavenger is made.
+    goalFieldsReady = false;
+    fieldCache = NULL;
+    passabilityChanges = 0;
+
     //Initialize scavenger-related variables.
-    firstIngredientAttained = false;
-    secondIngredientAttained = false;
-    scavengerPos = -1;
-    scavengerHealth = 100;
+    numScavengers = 1;
+    numScavengersSent = 0;
+    firstIngredientCarrier = INGREDIENT_ON_MAP;
+    secondIngredientCarrier = INGREDIENT_ON_MAP;
 
     //Initialize end-of-the-game-related variables.
     vaccineApplied = false;
@@ -68,6 +93,9 @@ Board::Board(int rows, int cols, int numberOfHumans, int numberOfDoctors) {
     //Initialize logical board.
     initializeLandscapeBoard();
 
+    //Reserve room for everyone who can ever be on the board, so "agents" never reallocates.
+    agents.reserve(numHumans + WORSENED_INFECTED_COUNT);
+
     //Initialize status of the city.
     cityIsDestroyed = false;
     
@@ -80,121 +108,973 @@ Board::Board(int rows, int cols, int numberOfHumans, int numberOfDoctors) {
  * @brief The Board class destructor.
  * The Board destructor is responsible for any last-minute cleaning 
  * up that a Board object needs to do before being destroyed. In this case,
- * it needs to return all the memory borrowed for creating the Human objects.
+ * it needs to finish writing the checkpoint.
  */
 Board::~Board() {
-    for(int pos=0; pos<numHumans; ++pos) {
-        delete humans[pos];
-    }
+    finishCheckpoint();
 }
 
 /**
  * @brief The primary function that runs the simulation.
- * Initializes and fills the logical boards, creates human objects, infects some humans, then runs simulation until the game progresses to the end, or until the time exceeds 400.
+ * Initializes and fills the logical boards, creates human objects, infects some humans, then runs simulation until the game progresses to the end, or until the time exceeds "tickLimit" (400 by default).
  * Uses a for loop to control the simulation.
- * With each iteration, the logical boards and screen are updated, and updated statistics are printed out.
+ * With each iteration, the logical boards are updated by tick(). Unless the board is headless, a frame with updated statistics is then
+ * published for the render thread, and the loop sleeps for uSleepTime microseconds (if any).
+ * The render thread shows frames at its own fixed rate, so a fast simulation is never slowed down by the terminal.
+ * A board restored from a checkpoint skips setUp() and continues with the time unit after the checkpointed one.
+ * If a checkpoint file is set, a checkpoint is written every "checkpointInterval" time units.
+ * If a trace file is set, the run is recorded to it, starting from the state before the first time unit,
+ * with a keyframe every "traceKeyframeInterval" time units.
  */
 void Board::run() {
 
+    //Fill the logical boards and place the humans, unless continuing a checkpointed run.
+    int firstTime = 0;
+    if (restored) {
+        firstTime = currentTime+1;
+    }
+    else {
+        setUp();
+    }
+
+    //Record the starting state, then every event from here on.
+    if (! tracePath.empty()) {
+        Checkpoint start;
+        captureCheckpoint(start);
+        start.currentTime = firstTime-1;
+        if (! trace.open(tracePath, start)) {
+            cerr << "Could not write trace " << tracePath << endl;
+        }
+    }
+
+    //Start showing frames.
+    if (! headless) {
+        startRendering();
+    }
+
+
+    //-------The loop that runs the simulation---------
+    for(currentTime=firstTime; currentTime<=tickLimit; ++currentTime) {
+
+        //Advance the simulation by one time unit.
+        tick();
+
+        if (trace.isOpen()) {
+            trace.endTick(currentTime, numInfected, cityWallHealth, vaccineResearchProgress, int(scavengers.size()));
+            if (traceKeyframeInterval > 0 && currentTime % traceKeyframeInterval == 0) {
+                captureCheckpoint(traceKeyframe);
+                trace.keyframe(traceKeyframe);
+            }
+        }
+
+        //Headless runs skip all drawing and sleeping.
+        if (! headless) {
+            //Only draw when the render thread has taken the last frame, but always draw the final time unit.
+            if (frames.wantsFrame() || currentTime == timeToStopAt || currentTime == tickLimit) {
+                drawFrame();
+            }
+
+            //Sleep specified microseconds
+            if (uSleepTime > 0) {
+                usleep(uSleepTime);
+            }
+        }
+
+        //If end of simulation events, then break. Headless runs have nothing left to show once the outcome is settled.
+        if (currentTime == timeToStopAt || (headless && outcomeDecided)) {
+            break;
+        }
+
+        //Checkpoint the completed time unit.
+        if (checkpointInterval > 0 && currentTime % checkpointInterval == 0) {
+            saveCheckpointInBackground();
+        }
+
+    }//-------End of loop---------
+
+    finishCheckpoint();
+
+    if (trace.isOpen() && ! trace.close()) {
+        cerr << "Could not write trace " << tracePath << endl;
+    }
+
+    //Let the render thread show the final frame.
+    if (! headless) {
+        stopRendering();
+    }
+}
+
+
+/**
+ * @brief Makes room on the screen for the board plus the statistics below it, and starts the render thread.
+ */
+void Board::startRendering() {
+    int screenRows = numRows+STATISTICS_ROWS;
+    int screenCols = (numCols > STATISTICS_COLS) ? numCols : STATISTICS_COLS;
+    screen.resize(screenRows, screenCols);
+    display.resize(screenRows, screenCols);
+    frames.resize(screen.size());
+
+    simulationDone = false;
+    renderer = thread(&Board::renderLoop, this);
+}
+
+
+/**
+ * @brief Lets the render thread show the final frame and waits for it to finish,
+ * then positions the cursor so the prompt shows up on its own line.
+ */
+void Board::stopRendering() {
+    simulationDone.store(true, memory_order_release);
+    renderer.join();
+    cout << endl;
+}
+
+
+/**
+ * @brief Shows published frames at a fixed rate of one per "frameInterval" microseconds.
+ * Runs on its own thread and only touches "frames" and "display", never the simulation state.
+ * Returns once the simulation is done and its final frame has been shown.
+ */
+void Board::renderLoop() {
+    chrono::steady_clock::time_point nextFrame = chrono::steady_clock::now();
+
+    while (true) {
+        //Check before acquiring, so the final frame (published before the flag is set) is not missed.
+        bool done = simulationDone.load(memory_order_acquire);
+
+        if (frames.acquire()) {
+            display.swapBack(frames.readSlot());
+            display.present();
+        }
+
+        if (done) {
+            break;
+        }
+
+        //Wait for the next frame time. If presenting fell behind, start the schedule over instead of catching up.
+        nextFrame += chrono::microseconds(frameInterval);
+        chrono::steady_clock::time_point now = chrono::steady_clock::now();
+        if (nextFrame < now) {
+            nextFrame = now;
+        }
+        this_thread::sleep_until(nextFrame);
+    }
+}
+
+
+/**
+ * @brief Gets the board ready for the first time unit.
+ * Initializes and fills the logical landscapeBoard, then fills the board with people.
+ */
+void Board::setUp() {
     //Initialize and fill logical landscapeBoard.
     makeLandscape();
     markResearchFacility();
 
-    //Fill the logical "humans" board with people.
+    //Fill the board with people.
     populateCity();
     populateOutsideOfCity();
 
     //Used at end of game to "break" out of loop.
-    int timeToStopAt = -1;
+    timeToStopAt = -1;
+}
 
 
+/**
+ * @brief Advances the simulation by one time unit (the current value of "currentTime").
+ * Moves every human, spreads the infection, updates the scavenger and the progress variables, and handles timed and end-of-game events.
+ */
+void Board::tick() {
 
-    //-------The loop that runs the simulation---------
-    for(currentTime=0; currentTime<=400; ++currentTime) {
+    //Catch the scavenger's distance fields up with last time unit's wall changes.
+    updateGoalFields();
+
+    //Tell each human to try moving.
+    if (moveThreads > 0) {
+        moveAtOnce();
+    }
+    else {
+        moveInTurn();
+    }
+
+    //Deal with infection propagation.
+    processInfection();
+
+    //Check status of scavenger.
+    checkOnScavenger();
+
+    //Update numerical progress variables for the vaccine and the city wall.
+    updateResearchProgress();
+    updateCityWallHealth();
+
+    //Place the research facility walls on the logical landscapeBoard.
+    makeResearchFacility();
+
+
+    //At time 30, open the city gate.
+    if (currentTime == 30) {
+        openCityGate();
+    }
+    //At time 35, select the scavengers.
+    else if (currentTime == 35) {
+        selectScavenger();
+    }
+
+    //Endgame events and details.
+    advanceEndGame();
+}
+
+
+/**
+ * @brief Handles the end of the game, once per time unit after everything else has moved on.
+ * When vaccine research reaches 100% everyone is cured, and the run stops 15 time units later.
+ * When the city wall is down after time 150 with no scavenger left, the infection is worsened, and the run stops 15 time units after everyone is infected.
+ */
+void Board::advanceEndGame() {
+    if (vaccineResearchProgress == 100) {
+        if (! vaccineApplied) {
+            //Cure all infected.
+            applyVaccine();
+        }
+        else {
+            if (timeToStopAt == -1) {
+                //Set "timeToStopAt".
+                timeToStopAt = currentTime + 15;
+            }
+        }
+    }
+    else if (cityWallHealth == 0 && currentTime > 150 && scavengers.empty()) {
+        if (! infectionWorsened) {
+            //Create more infected.
+            makeInfectionWorse();
+        }
+        else {
+            if (allInfected() && timeToStopAt == -1) {
+                //Set "timeToStopAt".
+                timeToStopAt = currentTime + 15;
+            }
+        }
+    }
+
+    updateDecision();
+}
+
+
+/**
+ * @brief Settles the outcome of the run once it can no longer change.
+ * Applying the vaccine or worsening the infection settles it for good: research stops once the infection is worsened, and nobody
+ * can be infected after the vaccine. Otherwise the outcome is the time limit once neither can happen before it any more:
+ * research gains at most 0.8 a time unit, plus 9 once both ingredients are delivered (only possible while scavengers are alive
+ * or still to be sent), and the city wall loses at most 2 a time unit but must be down after time 150 for the infection to worsen.
+ * Runs that reach the time limit are not settled here; getSummary() reports them as REASON_TIME_LIMIT.
+ */
+void Board::updateDecision() {
+    if (outcomeDecided) return;
+
+    int remaining = tickLimit - currentTime;
+    if (vaccineApplied) {
+        decidedReason = REASON_VACCINE_APPLIED;
+    }
+    else if (infectionWorsened) {
+        decidedReason = REASON_INFECTION_WORSENED;
+    }
+    else if (remaining > 0) {
+        bool delivered = firstIngredientCarrier == INGREDIENT_DELIVERED && secondIngredientCarrier == INGREDIENT_DELIVERED;
+        float maxGain = (delivered || ! scavengers.empty() || currentTime < 35) ? 9.8f : 0.8f;
+
+        //A point of slack keeps rounding in the running total from settling a run that could still just make it.
+        bool vaccineOutOfReach = vaccineResearchProgress + maxGain*remaining < 99;
+        bool worseningOutOfReach = tickLimit <= 150 || cityWallHealth > 2*remaining;
+        if (! (vaccineOutOfReach && worseningOutOfReach)) return;
+        decidedReason = REASON_OUT_OF_TIME;
+    }
+    else {
+        return;
+    }
+
+    outcomeDecided = true;
+    decidedTime = currentTime;
+}
+
+
+/**
+ * @brief Moves every human, one after another.
+ * Each human chooses its move with the board's generator and moves before the next one chooses,
+ * so a human can step into a cell that another human left earlier in the same time unit.
+ * The class that chooses the move comes from the agent's role, with no virtual calls: scavengers are walked in step
+ * with "scavengers", which is in the same order, and everyone else moves as a Human built on the spot.
+ */
+void Board::moveInTurn() {
+    int row, col;
+    size_t nextScavenger = 0;
+
+    for(int pos=0; pos<numHumans; ++pos) {
+        if (agents.role[pos] == ROLE_SCAVENGER) {
+            scavengers[nextScavenger++].proposeMove(generator, row, col);
+        }
+        else {
+            Human(pos, this).proposeMove(generator, row, col);
+        }
+
+        if (row != agents.row[pos] || col != agents.col[pos]) {
+            if (trace.isOpen()) {
+                trace.move(pos, row-agents.row[pos], col-agents.col[pos]);
+            }
+            moveAgent(pos, row, col);
+        }
+    }
+}
+
+
+/**
+ * @brief Gives a human's priority for claiming a cell in moveAtOnce(). Lower values win.
+ * The mix is a bijection on 32 bits, so no two humans ever share a priority within a time unit,
+ * and which human wins a given cell changes from one time unit to the next.
+ * @param[in] id The human's agent id.
+ * @param[in] key A value drawn once for the time unit.
+ * @return The priority value.
+ */
+static uint32_t movePriority(int id, uint32_t key) {
+    uint32_t x = uint32_t(id) ^ key;
+    x ^= x >> 16;
+    x *= 0x7feb352dU;
+    x ^= x >> 15;
+    x *= 0x846ca68bU;
+    x ^= x >> 16;
+    return x;
+}
+
+
+/**
+ * @brief Moves every human at once, in two phases, spread over "movePool".
+ * (1) Every human chooses a cell against the board as it was at the start of the time unit, using a random stream
+ *     seeded from a per-time-unit key and its own id, and claims the cell by lowering the cell's entry in "claims" to its priority.
+ * (2) Each claimed cell goes to the human with the lowest priority; the others stay where they are.
+ * Neither phase depends on the order humans are processed in, so the result is the same for any number of threads.
+ * That also lets phase 1 go by type: everyone but the scavengers as Humans, spread over the threads, then the scavengers as a batch.
+ * The moves are then carried out, and the claims cleared, on the calling thread.
+ */
+void Board::moveAtOnce() {
+    //Both keys come from the board's generator, so runs stay reproducible from the seed.
+    uint64_t tickKey = generator.next();
+    uint32_t priorityKey = uint32_t(tickKey >> 32);
+
+    if (claims.size() != occupancy.size()) {
+        claims = vector<atomic<uint32_t> >(occupancy.size());
+        for (size_t cell=0; cell<claims.size(); cell++) {
+            claims[cell].store(UNCLAIMED, memory_order_relaxed);
+        }
+    }
+    moveTarget.resize(numHumans);
+
+    //Claim the cell a human chose, by an atomic minimum of the claims on it.
+    auto claim = [&](int id, int row, int col) {
+        if (row == agents.row[id] && col == agents.col[id]) {
+            moveTarget[id] = -1;
+            return;
+        }
+
+        int cell = cellIndex(row, col);
+        moveTarget[id] = cell;
+
+        uint32_t priority = movePriority(id, priorityKey);
+        uint32_t current = claims[cell].load(memory_order_relaxed);
+        while (priority < current && ! claims[cell].compare_exchange_weak(current, priority, memory_order_relaxed)) {
+        }
+    };
+
+    //Phase 1: choose and claim.
+    movePool.parallelFor(numHumans, [&](int begin, int end) {
+        int row, col;
+        for (int id=begin; id<end; id++) {
+            if (agents.role[id] == ROLE_SCAVENGER) continue;
+
+            Random dice(Random::hash(tickKey, id));
+            Human(id, this).proposeMove(dice, row, col);
+            claim(id, row, col);
+        }
+    });
+    for (size_t s=0; s<scavengers.size(); s++) {
+        int row, col;
+        int id = scavengers[s].getId();
+        Random dice(Random::hash(tickKey, id));
+        scavengers[s].proposeMove(dice, row, col);
+        claim(id, row, col);
+    }
+
+    //Phase 2: humans that lost their cell stay put.
+    movePool.parallelFor(numHumans, [&](int begin, int end) {
+        for (int id=begin; id<end; id++) {
+            int cell = moveTarget[id];
+            if (cell >= 0 && claims[cell].load(memory_order_relaxed) != movePriority(id, priorityKey)) {
+                moveTarget[id] = -1;
+            }
+        }
+    });
+
+    //Carry out the winning moves. Every claimed cell has exactly one winner, so this also clears every claim.
+    for (int id=0; id<numHumans; id++) {
+        int cell = moveTarget[id];
+        if (cell < 0) continue;
+
+        int row = cell / numCols;
+        int col = cell % numCols;
+        if (trace.isOpen()) {
+            trace.move(id, row-agents.row[id], col-agents.col[id]);
+        }
+        moveAgent(id, row, col);
+        claims[cell].store(UNCLAIMED, memory_order_relaxed);
+    }
+}
+
+
+/**
+ * @brief Draws the current time unit and publishes it for the render thread.
+ * Draws the logical landscapeBoard, every human, and the statistics into a blank frame of "screen",
+ * then hands the finished frame over through "frames" without copying it.
+ */
+void Board::drawFrame() {
+    //Start from a blank frame.
+    screen.clear();
+
+    //Display the logical landscapeBoard.
+    drawLandscape();
+
+    //Draw each human on board with updated infection status.
+    drawHumans();
+
+    //Print statistics.
+    printStatistics(currentTime);
+
+    //Hand the frame to the render thread, and take back a spare slot to draw the next one into.
+    screen.swapBack(frames.writeSlot());
+    frames.publish();
+}
+
+
+/**
+ * @brief Sets the file run() records the run to.
+ * The trace starts with the state before the first time unit and then holds every move, infection, heal, role change,
+ * landscape change, scavenger milestone, and end-game event, with the statistics at the end of each time unit (see Trace).
+ * Events are written on a background thread.
+ * @param[in] path The trace file, or "" to not record.
+ * @param[in] keyframeEvery Write a keyframe after every time unit that is a multiple of this. 0 for never.
+ */
+void Board::setTraceFile(const string& path, int keyframeEvery) {
+    tracePath = path;
+    traceKeyframeInterval = keyframeEvery;
+}
+
+
+/**
+ * @brief Plays back a recorded run through the same drawing and render thread as run().
+ * Starts by seeking to "fromTime". Playing forward applies the trace's events "timeUnitsPerFrame" time units at a time;
+ * playing backward seeks to each earlier time unit, which keyframes keep cheap. Sleeps "uSleepTime" microseconds between frames.
+ * Stops early if the trace ends before "toTime".
+ * @param[in] reader The open trace.
+ * @param[in] fromTime The first time unit to show.
+ * @param[in] toTime The last time unit to show.
+ * @param[in] timeUnitsPerFrame Time units to advance per frame. Negative plays backward; must not be 0.
+ */
+void Board::replay(TraceReader& reader, int fromTime, int toTime, int timeUnitsPerFrame) {
+    //Headless boards have nothing to show, only the state to end up in.
+    if (headless) {
+        seekTrace(reader, toTime);
+        return;
+    }
+
+    startRendering();
+
+    bool more = seekTrace(reader, fromTime);
+    while (true) {
+        bool last = ! more || (timeUnitsPerFrame > 0 ? currentTime >= toTime : currentTime <= toTime);
+        if (frames.wantsFrame() || last) {
+            drawFrame();
+        }
+        if (last) {
+            break;
+        }
+
+        if (uSleepTime > 0) {
+            usleep(uSleepTime);
+        }
+
+        if (timeUnitsPerFrame > 0) {
+            for (int step=0; step<timeUnitsPerFrame && currentTime<toTime && more; step++) {
+                more = playTraceTimeUnit(reader);
+            }
+        }
+        else {
+            int time = currentTime + timeUnitsPerFrame;
+            more = seekTrace(reader, (time < toTime) ? toTime : time);
+        }
+    }
+
+    stopRendering();
+}
+
+
+/**
+ * @brief Puts the board in the state of a recorded run after a given time unit.
+ * Restores the last keyframe at or before that time unit with restoreCheckpoint(), then applies the events up to it.
+ * @param[in] reader The open trace.
+ * @param[in] time The time unit.
+ * @return false if the trace ends (or is damaged) before "time". The board is then at the last time unit that could be read.
+ */
+bool Board::seekTrace(TraceReader& reader, int time) {
+    if (! reader.seek(time, traceKeyframe)) {
+        return false;
+    }
+    restoreCheckpoint(traceKeyframe);
+
+    while (currentTime < time) {
+        if (! playTraceTimeUnit(reader)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+/**
+ * @brief Applies the events of the next time unit in a trace, through its TRACE_END_TICK.
+ * @param[in] reader The open trace.
+ * @return false if the trace ends first.
+ */
+bool Board::playTraceTimeUnit(TraceReader& reader) {
+    TraceEvent event;
+    while (reader.next(event)) {
+        applyTraceEvent(event);
+        if (event.tag == TRACE_OTHER && event.other == TRACE_END_TICK) {
+            return true;
+        }
+    }
+    return false;
+}
 
-        //Clear screen before every new time unit.
-        cout << conio::clrscr() << flush;
 
-        //Tell each human to try moving.
-        for(int pos=0; pos<numHumans; ++pos) {
-            humans[pos]->move();
+/**
+ * @brief Makes the change a trace event records, the same way the recorded board made it.
+ * Goes through moveAgent(), changeRole(), addAgent(), and setLandscape(), so "agents", "scavengers", and "occupancy" stay in sync.
+ * @param[in] event The event.
+ */
+void Board::applyTraceEvent(const TraceEvent& event) {
+    switch (event.tag) {
+        case TRACE_MOVE:
+            moveAgent(event.id, agents.row[event.id]+event.rowDelta, agents.col[event.id]+event.colDelta);
+            break;
+        case TRACE_INFECT:
+            agents.infected[event.id] = true;
+            break;
+        case TRACE_HEAL:
+            agents.infected[event.id] = false;
+            break;
+        case TRACE_HURT:
+            agents.health[event.id] -= 25;
+            break;
+        case TRACE_ROLE:
+            changeRole(event.id, event.role);
+            if (event.role == ROLE_SCAVENGER) {
+                buildGoalFields();
+            }
+            break;
+        case TRACE_PROGRESS: {
+            //Follow the ingredients from the milestones of the scavengers carrying them.
+            unsigned char gained = event.progress & ~agents.progress[event.id];
+            agents.progress[event.id] = event.progress;
+            if (gained & HAS_FIRST_INGREDIENT) {
+                firstIngredientCarrier = event.id;
+            }
+            if (gained & HAS_SECOND_INGREDIENT) {
+                secondIngredientCarrier = event.id;
+            }
+            if (gained & REACHED_RESEARCH_FACILITY) {
+                deliverIngredients(event.id);
+            }
+            break;
         }
+        case TRACE_LANDSCAPE:
+            //An ingredient reappears when its carrier dies, not always where it was found.
+            if (event.marker == FIRST_INGREDIENT || event.marker == SECOND_INGREDIENT) {
+                placeIngredient(event.marker, event.cell / numCols, event.cell % numCols);
+                if (event.marker == FIRST_INGREDIENT) {
+                    firstIngredientCarrier = INGREDIENT_ON_MAP;
+                }
+                else {
+                    secondIngredientCarrier = INGREDIENT_ON_MAP;
+                }
+            }
+            else {
+                setLandscape(event.cell / numCols, event.cell % numCols, event.marker);
+            }
+            break;
+        case TRACE_OTHER:
+            switch (event.other) {
+                case TRACE_END_TICK:
+                    currentTime = event.time;
+                    numInfected = event.numInfected;
+                    cityWallHealth = event.cityWallHealth;
+                    vaccineResearchProgress = event.vaccineResearchProgress;
+                    if (cityWallHealth == 0) {
+                        cityIsDestroyed = true;
+                    }
+                    updateDecision();
+                    break;
+                case TRACE_ADD_AGENT:
+                    addAgent(event.row, event.col, event.infected, event.role);
+                    numHumans++;
+                    break;
+                case TRACE_VACCINE_APPLIED:
+                    for (int pos=0; pos<numHumans; pos++) {
+                        agents.infected[pos] = false;
+                    }
+                    vaccineApplied = true;
+                    break;
+                case TRACE_INFECTION_WORSENED:
+                    infectionWorsened = true;
+                    break;
+                default:
+                    break;
+            }
+            break;
+    }
+}
 
-        //Deal with infection propagation.
-        processInfection();
 
-        //Check status of scavenger.
-        checkOnScavenger();
+/**
+ * @brief Turns headless mode on or off.
+ * A headless board never draws to the screen or sleeps between time units, so it runs at full speed.
+ * @param[in] isHeadless Whether the board should run headless.
+ */
+void Board::setHeadless(bool isHeadless) {
+    headless = isHeadless;
+}
+
+
+/**
+ * @brief Sets how many scavengers selectScavenger() sends out at time 35.
+ * They race each other for the ingredients; whoever reaches one first carries it, and the others go after what is left.
+ * Call before run(). A restored board takes the number from its checkpoint.
+ * @param[in] count The number of scavengers.
+ */
+void Board::setNumScavengers(int count) {
+    numScavengers = count;
+}
+
+
+/**
+ * @brief Chooses the movement rule.
+ * With 0, humans move one after another (moveInTurn()). Otherwise they all choose their moves at once and conflicts are
+ * settled by priority (moveAtOnce()), with the work spread over "numThreads" threads. The two rules give different games,
+ * but the second gives the same game for a given seed no matter how many threads it uses.
+ * Call at most once, before run().
+ * @param[in] numThreads 0 for the one-after-another rule, or the number of threads for the all-at-once rule.
+ */
+void Board::setMoveThreads(int numThreads) {
+    moveThreads = numThreads;
+    if (moveThreads > 0) {
+        movePool.start(moveThreads);
+    }
+}
+
+
+/**
+ * @brief Chooses the infection rule.
+ * The bitboard rule gives a different game from the default rule for the same seed, but costs far less on crowded boards.
+ * @param[in] enabled Whether to infect everyone at once on bitboards.
+ */
+void Board::setBitboardInfection(bool enabled) {
+    bitboardInfection = enabled;
+}
+
+
+/**
+ * @brief Shares the goal distance fields with other boards of the same scenario.
+ * Ensembles give every board played on a thread the same cache, so the fields for the walls and gate of the scenario are built
+ * once per goal cell instead of once per game. Fields from the cache are repaired for this board's ingredients, so the game is unchanged.
+ * @param[in] cache The cache, or NULL to build the fields on this board. It must outlive the board's run.
+ */
+void Board::setFieldCache(FieldCache* cache) {
+    fieldCache = cache;
+}
+
+
+/**
+ * @brief Sets how long the simulation waits after each time unit.
+ * This only sets the simulation speed; the display rate is set by setFrameRate().
+ * @param[in] microseconds The delay, or 0 to run the simulation as fast as possible.
+ */
+void Board::setTickDelay(int microseconds) {
+    uSleepTime = microseconds;
+}
+
+
+/**
+ * @brief Sets how often the render thread shows a frame.
+ * @param[in] framesPerSecond The display rate. Must be positive.
+ */
+void Board::setFrameRate(int framesPerSecond) {
+    frameInterval = 1000000/framesPerSecond;
+}
+
+
+/**
+ * @brief Sets the last time unit the simulation may reach.
+ * @param[in] limit The last value of "currentTime" that will be simulated.
+ */
+void Board::setTickLimit(int limit) {
+    tickLimit = limit;
+}
+
 
-        //Update numerical progress variables for the vaccine and the city wall.
-        updateResearchProgress();
-        updateCityWallHealth();
+/**
+ * @brief Summarizes how the run ended.
+ * Meant to be called after run() or replay() returns. A replay stopped before the time limit, with the outcome still open,
+ * is reported as OUTCOME_IN_PROGRESS rather than as a run that ran out of time.
+ * @return The outcome, the time unit the run stopped at, and the final infected count, vaccine progress, and city wall health.
+ */
+RunSummary Board::getSummary() {
+    RunSummary summary;
+
+    if (vaccineApplied) {
+        summary.outcome = OUTCOME_VACCINE;
+    }
+    else if (infectionWorsened) {
+        summary.outcome = OUTCOME_INFECTION;
+    }
+    else {
+        summary.outcome = OUTCOME_TIME_LIMIT;
+    }
+
+    //"currentTime" is one past the limit when the loop runs to the end.
+    summary.endTick = (currentTime > tickLimit) ? tickLimit : currentTime;
+    summary.reason = outcomeDecided ? decidedReason : REASON_TIME_LIMIT;
+    if (! outcomeDecided && summary.endTick < tickLimit) {
+        summary.outcome = OUTCOME_IN_PROGRESS;
+        summary.reason = REASON_IN_PROGRESS;
+    }
+    summary.decidedTick = outcomeDecided ? decidedTime : summary.endTick;
+    summary.numHumans = numHumans;
+    summary.numInfected = numInfected;
+    summary.vaccineResearchProgress = vaccineResearchProgress;
+    summary.cityWallHealth = cityWallHealth;
 
-        //Place the research facility walls on the logical landscapeBoard.
-        makeResearchFacility();
+    return summary;
+}
+
+
+/**
+ * @brief Copies the whole state of the board into a checkpoint.
+ * Covers everything tick() depends on, including the random number generator, so restoring it continues the run exactly.
+ * Only copies memory; encoding and writing the checkpoint is left to the caller.
+ * @param[out] checkpoint Where to put the state. Its arrays are reused if they are already big enough.
+ */
+void Board::captureCheckpoint(Checkpoint& checkpoint) {
+    checkpoint.numRows = numRows;
+    checkpoint.numCols = numCols;
+    checkpoint.numHumans = numHumans;
+    checkpoint.numDoctors = numDoctors;
+    checkpoint.numInfected = numInfected;
+
+    checkpoint.currentTime = currentTime;
+    checkpoint.tickLimit = tickLimit;
+    checkpoint.timeToStopAt = timeToStopAt;
+
+    checkpoint.movesAtOnce = (moveThreads > 0);
+    checkpoint.bitboardInfection = bitboardInfection;
+
+    checkpoint.landscape = landscapeBoard;
+    checkpoint.cityIsDestroyed = cityIsDestroyed;
+    checkpoint.cityStartingColumn = cityStartingColumn;
+    checkpoint.cityEndingRow = cityEndingRow;
+    checkpoint.researchFacilityEndingRow = researchFacilityEndingRow;
+    checkpoint.researchFacilityStartingCol = researchFacilityStartingCol;
+    checkpoint.firstIngredientRow = firstIngredientRow;
+    checkpoint.firstIngredientCol = firstIngredientCol;
+    checkpoint.secondIngredientRow = secondIngredientRow;
+    checkpoint.secondIngredientCol = secondIngredientCol;
+    checkpoint.gateRow = gateRow;
+    checkpoint.gateCol = gateCol;
+    checkpoint.researchFacilityRow = researchFacilityRow;
+    checkpoint.researchFacilityCol = researchFacilityCol;
+
+    checkpoint.numScavengers = numScavengers;
+    checkpoint.numScavengersSent = numScavengersSent;
+    checkpoint.firstIngredientCarrier = firstIngredientCarrier;
+    checkpoint.secondIngredientCarrier = secondIngredientCarrier;
+    checkpoint.cityWallHealth = cityWallHealth;
+    checkpoint.vaccineResearchProgress = vaccineResearchProgress;
+    checkpoint.vaccineApplied = vaccineApplied;
+    checkpoint.infectionWorsened = infectionWorsened;
+
+    checkpoint.agents = agents;
+    checkpoint.generator = generator;
+    checkpoint.seed = startingSeed;
+}
+
+
+/**
+ * @brief Replaces the state of the board with a checkpoint.
+ * The board must have been constructed with the checkpoint's rows and columns, and not run yet.
+ * The checkpoint's movement and infection rules replace the board's; with the all-at-once rule, threads already set by setMoveThreads() are kept.
+ * The landscape goes through setLandscape() and the agents through addAgent(), so "occupancy" and the "scavengers" batch are rebuilt
+ * to match, and the goal fields are built again if there are scavengers. The next run() continues with the time unit after the checkpointed one.
+ * @param[in] checkpoint The state to continue from.
+ */
+void Board::restoreCheckpoint(const Checkpoint& checkpoint) {
+    numHumans = checkpoint.numHumans;
+    numDoctors = checkpoint.numDoctors;
+    numInfected = checkpoint.numInfected;
 
-        //Display the logical landscapeBoard.
-        drawLandscape();
+    currentTime = checkpoint.currentTime;
+    tickLimit = checkpoint.tickLimit;
+    timeToStopAt = checkpoint.timeToStopAt;
 
+    //Settled again by the next time unit, against whatever time limit the run goes on with.
+    outcomeDecided = false;
 
-        //At time 30, open the city gate.
-        if (currentTime == 30) {
-            openCityGate();
+    //Go on by the movement rule the run was played by. How many threads move the humans does not change the game.
+    if (checkpoint.movesAtOnce && moveThreads == 0) {
+        setMoveThreads(1);
+    }
+    else if (! checkpoint.movesAtOnce) {
+        moveThreads = 0;
+    }
+    bitboardInfection = checkpoint.bitboardInfection;
+
+    cityIsDestroyed = checkpoint.cityIsDestroyed;
+    cityStartingColumn = checkpoint.cityStartingColumn;
+    cityEndingRow = checkpoint.cityEndingRow;
+    researchFacilityEndingRow = checkpoint.researchFacilityEndingRow;
+    researchFacilityStartingCol = checkpoint.researchFacilityStartingCol;
+    firstIngredientRow = checkpoint.firstIngredientRow;
+    firstIngredientCol = checkpoint.firstIngredientCol;
+    secondIngredientRow = checkpoint.secondIngredientRow;
+    secondIngredientCol = checkpoint.secondIngredientCol;
+    gateRow = checkpoint.gateRow;
+    gateCol = checkpoint.gateCol;
+    researchFacilityRow = checkpoint.researchFacilityRow;
+    researchFacilityCol = checkpoint.researchFacilityCol;
+
+    numScavengers = checkpoint.numScavengers;
+    numScavengersSent = checkpoint.numScavengersSent;
+    firstIngredientCarrier = checkpoint.firstIngredientCarrier;
+    secondIngredientCarrier = checkpoint.secondIngredientCarrier;
+    cityWallHealth = checkpoint.cityWallHealth;
+    vaccineResearchProgress = checkpoint.vaccineResearchProgress;
+    vaccineApplied = checkpoint.vaccineApplied;
+    infectionWorsened = checkpoint.infectionWorsened;
+
+    generator = checkpoint.generator;
+    startingSeed = checkpoint.seed;
+
+    //Landscape, keeping the CELL_BLOCKED flags in sync. The goal fields are built again from it for the scavengers.
+    goalFieldsReady = false;
+    changedCells.clear();
+    initializeLandscapeBoard();
+    for (int row=0; row<numRows; row++) {
+        for (int col=0; col<numCols; col++) {
+            setLandscape(row, col, checkpoint.landscape[cellIndex(row, col)]);
         }
-        //At time 35, select a scavenger.
-        else if (currentTime == 35) {
-            selectScavenger();
+    }
+
+    //Agents, with room for the infected that makeInfectionWorse() may still add.
+    scavengers.clear();
+    agents = AgentStore();
+    agents.reserve(numHumans + (infectionWorsened ? 0 : WORSENED_INFECTED_COUNT));
+
+    for (int id=0; id<numHumans; id++) {
+        addAgent(checkpoint.agents.row[id], checkpoint.agents.col[id], checkpoint.agents.infected[id], AgentRole(checkpoint.agents.role[id]));
+
+        //A scavenger joining the batch starts with no progress and full health, so put them back afterwards.
+        agents.progress[id] = checkpoint.agents.progress[id];
+        agents.health[id] = checkpoint.agents.health[id];
+        if (agents.role[id] == ROLE_SCAVENGER) {
+            buildGoalFields();
         }
+    }
 
+    restored = true;
+}
+
+
+/**
+ * @brief Sets where and how often run() writes checkpoints.
+ * Each checkpoint replaces the previous one. Checkpoints are written on a background thread, so the tick loop only pays for copying the state.
+ * @param[in] path The checkpoint file.
+ * @param[in] everyTicks Write after every time unit that is a multiple of this. 0 for never.
+ */
+void Board::setCheckpointFile(const string& path, int everyTicks) {
+    checkpointPath = path;
+    checkpointInterval = everyTicks;
+}
+
+
+/**
+ * @brief Starts writing a checkpoint of the current state to "checkpointPath".
+ * Waits for the previous checkpoint first, so at most one is ever being written. The state is copied into
+ * "pendingCheckpoint" here, and "checkpointWriter" encodes and writes it while the simulation goes on.
+ */
+void Board::saveCheckpointInBackground() {
+    finishCheckpoint();
+    captureCheckpoint(pendingCheckpoint);
 
-        //Endgame events and details.
-        if (vaccineResearchProgress == 100) {
-            if (! vaccineApplied) {
-                //Cure all infected.
-                applyVaccine();
-            }
-            else {
-                if (timeToStopAt == -1) {
-                    //Set "timeToStopAt".
-                    timeToStopAt = currentTime + 15;
-                }
-            }
-        }
-        else if (cityWallHealth == 0 && currentTime > 150 && scavengerHealth == 0) {
-            if (! infectionWorsened) {
-                //Create more infected.
-                makeInfectionWorse();
-            }
-            else {
-                if (allInfected() && timeToStopAt == -1) {
-                    //Set "timeToStopAt".
-                    timeToStopAt = currentTime + 15;
-                }
-            }
+    checkpointWriter = thread([this]() {
+        if (! pendingCheckpoint.save(checkpointPath)) {
+            cerr << "Could not write checkpoint " << checkpointPath << endl;
         }
+    });
+}
 
 
-        //Tell each human to draw itself on board with updated infection status.
-        for(int pos=0; pos<numHumans; ++pos) {
-            humans[pos]->draw();
-        }
+/**
+ * @brief Waits for the checkpoint being written, if there is one.
+ */
+void Board::finishCheckpoint() {
+    if (checkpointWriter.joinable()) {
+        checkpointWriter.join();
+    }
+}
 
-        //Print statistics.
-        printStatistics(currentTime);
-        cout << conio::resetAll() << flush;
-        
-        //Sleep specified microseconds
-        usleep(uSleepTime);
 
-        //If end of simulation events, then break.
-        if (currentTime == timeToStopAt) {
-            break;
-        }
+/**
+ * @brief Gives the machine-readable name of a game outcome.
+ * @param[in] outcome The outcome to name.
+ * @return "vaccine", "infection", "time_limit", or "in_progress".
+ */
+const char* outcomeName(GameOutcome outcome) {
+    switch (outcome) {
+        case OUTCOME_VACCINE:
+            return "vaccine";
+        case OUTCOME_INFECTION:
+            return "infection";
+        case OUTCOME_IN_PROGRESS:
+            return "in_progress";
+        default:
+            return "time_limit";
+    }
+}
 
-    }//-------End of loop---------
 
-    //Position the cursor so prompt shows up on its own line
-    cout << endl;
+/**
+ * @brief Gives the machine-readable name of an outcome reason.
+ * @param[in] reason The reason to name.
+ * @return "vaccine_applied", "infection_worsened", "out_of_time", "time_limit", or "in_progress".
+ */
+const char* reasonName(OutcomeReason reason) {
+    switch (reason) {
+        case REASON_VACCINE_APPLIED:
+            return "vaccine_applied";
+        case REASON_INFECTION_WORSENED:
+            return "infection_worsened";
+        case REASON_OUT_OF_TIME:
+            return "out_of_time";
+        case REASON_IN_PROGRESS:
+            return "in_progress";
+        default:
+            return "time_limit";
+    }
 }
 
 
@@ -204,7 +1084,7 @@ void Board::run() {
  */
 bool Board::allInfected() {
     for(int i=0; i<numHumans; ++i) {
-        if(humans[i]->getObjectType() != "Doctor" && humans[i]->isInfected() == false) return false;
+        if(agents.role[i] != ROLE_DOCTOR && agents.infected[i] == false) return false;
     }
 
     return true;
@@ -216,113 +1096,308 @@ bool Board::allInfected() {
  * For each pair of adjacent humans in the simulation, processInfection() makes sure that if one is infected, the other becomes infected as well.
  * But if one of these people is a doctor, the other person will become healed.
  * And if one of them is a scavenger and comes into contact with an infected, the scavenger loses 1/4 of its health.
+ * The rules are applied by infectInTurn(), or by infectAtOnce() when bitboard infection is on. Then the infected are recounted.
  */
 void Board::processInfection() {
+    if (bitboardInfection) {
+        infectAtOnce();
+    }
+    else {
+        infectInTurn();
+    }
+
+    // Reset the board 'numInfected' count and recount how many are infected.
+    numInfected = 0;
+    for( int i=0; i<numHumans; ++i ) {
+        numInfected += agents.infected[i];
+    }
+}
+
+
+/**
+ * @brief Applies the infection rules to every pair of adjacent humans, one pair after another.
+ * Adjacent pairs are found through "neighborGrid", so only the 3x3 block around each human is visited.
+ * Pairs are still handled in the same (i, j) order as a full pairwise scan, so the outcome is unchanged.
+ */
+void Board::infectInTurn() {
+    //Bucket every human by cell. Inserting from the highest id down keeps each cell's list ascending.
+    neighborGrid.reset(numHumans);
+    for( int i=numHumans-1; i>=0; --i ) {
+        neighborGrid.insert(i, agents.row[i], agents.col[i]);
+    }
+
     for( int i=0; i<numHumans; ++i ) {
-        for( int j=i+1; j<numHumans; ++j ) {
-            if( isNextTo(humans[i], humans[j]) ){
+        neighborGrid.gatherNeighbors(agents.row[i], agents.col[i], i, neighbors);
 
-                //HEAL
-                if (humans[i]->getObjectType() == "Doctor" && humans[j]->isInfected()) {
-                    //Doctor + Infected = heal.
-                    humans[j]->setUnInfected();
-                }
-                else if (humans[j]->getObjectType() == "Doctor" && humans[i]->isInfected()) {
-                    //Infected + Doctor = heal.
-                    humans[i]->setUnInfected();
-                }
+        for( size_t n=0; n<neighbors.size(); ++n ) {
+            processContact(i, neighbors[n]);
+        }
+    }
+}
 
-                //INFECT
-                else if( humans[i]->isInfected() && humans[j]->isInfected()==false ) {
-                    //Deal with scavenger
-                    if (humans[j]->getObjectType()=="Scavenger") {
-                        //Hurt the scavenger.
-                        scavengerHealth -= 25;
-                        if (scavengerHealth <= 0) {
-                            //If scavenger dead, replace with infected human.
-                            int row,col;
-                            humans[j]->getLocation(row,col);
-                            delete humans[j];
-                            humans[j] = new Human(row,col,true,this);
-                        }
-                    }
-                    else {
-                        //Infected + Human = infect.
-                        humans[j]->setInfected();
-                    }
-                } 
-                else if ( humans[j]->isInfected() && humans[i]->isInfected()==false ) {
-                    //Deal with scavenger
-                    if (humans[i]->getObjectType()=="Scavenger") {
-                        //Hurt the scavenger.
-                        scavengerHealth -= 25;
-                        if (scavengerHealth <= 0) {
-                            //If scavenger dead, replace with infected human.
-                            int row,col;
-                            humans[i]->getLocation(row,col);
-                            delete humans[i];
-                            humans[i] = new Human(row,col,true,this);
-                        }
-                    }
-                    else {
-                        //Human + Infected = infect.
-                        humans[i]->setInfected();
-                    }
-                }
-            }
+
+/**
+ * @brief Applies the infection rules to everyone at once, on "infectionBitboard".
+ * Healthy humans next to an infected are infected unless a doctor is next to them too, and infected humans next to a doctor are healed,
+ * judged from where everyone stood at the start. Scavengers lose 1/4 of their health for each cell next to them holding an infected.
+ * Doctors are never infected, as with infectInTurn().
+ */
+void Board::infectAtOnce() {
+    infectionBitboard.clear();
+    for (int id=0; id<numHumans; id++) {
+        if (agents.role[id] == ROLE_DOCTOR) {
+            infectionBitboard.addDoctor(agents.row[id], agents.col[id]);
+        }
+        else if (agents.infected[id]) {
+            infectionBitboard.addInfected(agents.row[id], agents.col[id]);
+        }
+        else if (agents.role[id] == ROLE_HUMAN) {
+            infectionBitboard.addHealthy(agents.row[id], agents.col[id]);
         }
     }
+    infectionBitboard.spread();
 
-    // Reset the board 'numInfected' count and recount how many are infected.
-    numInfected = 0;
-    for( int i=0; i<numHumans; ++i ) {
-        if( humans[i]->isInfected() ) {
-            numInfected++;
+    for (int id=0; id<numHumans; id++) {
+        if (agents.role[id] != ROLE_HUMAN) continue;
+
+        if (agents.infected[id] && infectionBitboard.heals(agents.row[id], agents.col[id])) {
+            agents.infected[id] = false;
+            if (trace.isOpen()) trace.heal(id);
+        }
+        else if (! agents.infected[id] && infectionBitboard.infects(agents.row[id], agents.col[id])) {
+            agents.infected[id] = true;
+            if (trace.isOpen()) trace.infect(id);
+        }
+    }
+
+    //Going backward, so a scavenger that dies and leaves "scavengers" does not skip the next one.
+    for (int s=int(scavengers.size())-1; s>=0; s--) {
+        int id = scavengers[s].getId();
+        int contacts = infectionBitboard.countInfectedAround(agents.row[id], agents.col[id]);
+        for (int contact=0; contact<contacts && agents.role[id] == ROLE_SCAVENGER; contact++) {
+            hurtScavenger(id);
         }
     }
 }
 
+
+/**
+ * @brief Applies the heal/infect/scavenger-damage rules to one pair of adjacent humans.
+ * @param[in] i The id of the first human.
+ * @param[in] j The id of the second human (j > i).
+ */
+void Board::processContact(int i, int j) {
+    vector<unsigned char>& infected = agents.infected;
+    vector<unsigned char>& role = agents.role;
+
+    //HEAL
+    if (role[i] == ROLE_DOCTOR && infected[j]) {
+        //Doctor + Infected = heal.
+        infected[j] = false;
+        if (trace.isOpen()) trace.heal(j);
+    }
+    else if (role[j] == ROLE_DOCTOR && infected[i]) {
+        //Infected + Doctor = heal.
+        infected[i] = false;
+        if (trace.isOpen()) trace.heal(i);
+    }
+
+    //INFECT
+    else if( infected[i] && !infected[j] ) {
+        //Deal with scavenger
+        if (role[j] == ROLE_SCAVENGER) {
+            hurtScavenger(j);
+        }
+        else {
+            //Infected + Human = infect.
+            infected[j] = true;
+            if (trace.isOpen()) trace.infect(j);
+        }
+    } 
+    else if ( infected[j] && !infected[i] ) {
+        //Deal with scavenger
+        if (role[i] == ROLE_SCAVENGER) {
+            hurtScavenger(i);
+        }
+        else {
+            //Human + Infected = infect.
+            infected[i] = true;
+            if (trace.isOpen()) trace.infect(i);
+        }
+    }
+}
+
+
+/**
+ * @brief Hurts a scavenger after contact with an infected.
+ * The scavenger loses 1/4 of its health. If it dies, it is replaced with an infected human,
+ * and any ingredient it was carrying goes back on the map for the other scavengers to fetch (see dropIngredient()).
+ * @param[in] id The scavenger's agent id.
+ */
+void Board::hurtScavenger(int id) {
+    agents.health[id] -= 25;
+    if (trace.isOpen()) trace.hurt(id);
+
+    if (agents.health[id] == 0) {
+        //Drop the ingredients.
+        if (firstIngredientCarrier == id) {
+            firstIngredientCarrier = INGREDIENT_ON_MAP;
+            dropIngredient(FIRST_INGREDIENT, id);
+        }
+        if (secondIngredientCarrier == id) {
+            secondIngredientCarrier = INGREDIENT_ON_MAP;
+            dropIngredient(SECOND_INGREDIENT, id);
+        }
+
+        //If scavenger dead, replace with infected human.
+        changeRole(id, ROLE_HUMAN);
+        agents.infected[id] = true;
+        if (trace.isOpen()) trace.infect(id);
+    }
+}
+
 /**
  * @brief The function that determines whether a particular move can happen.
- * If the move would go off the board, or land on the same position as another human, the function returns false (do not move). Otherwise, it returns true (ok to proceed).
+ * If the move would go off the board, land on the same position as another human, or land on a landscape object (ex: a wall), the function returns false (do not move). Otherwise, it returns true (ok to proceed).
+ * Answered with a single lookup in the "occupancy" index.
  * @param[in] row The row the human wishes to move to.
  * @param[in] col The column the human wishes to move to.
  * @return Whether the human calling this function may move to the specified row and column.
  */
 bool Board::tryMove(int row, int col) {
-    int tryRow, tryCol=-1;
-
     // If off board, the move is not permitted.
     if( row<0 || row>=numRows || col<0 || col>=numCols ) return false;
 
-    // Else if another human is on the same location, the move is not permitted.
-    // Or if trying to go through a landscape object (ex: a wall).
-    for(int i=0; i<numHumans; ++i) {
-        humans[i]->getLocation(tryRow, tryCol);
-        //Trying to move on top of another human is not permitted.
-        if( row==tryRow && col==tryCol ) return false;
-        //Research floor IS permitted.
-        else if (landscapeBoard[row][col] == RESEARCH_FLOOR) return true;
-        //But anything else is not permitted.
-        else if (landscapeBoard[row][col] != EMPTY) return false;
+    // The cell must be walkable (EMPTY or RESEARCH_FLOOR) and have nobody on it.
+    return occupancy[cellIndex(row, col)] == 0;
+}
+
+
+/**
+ * @brief Moves a human from one cell of the occupancy index to another.
+ * Called whenever a human changes its location.
+ * @param[in] fromRow The row the human is leaving.
+ * @param[in] fromCol The column the human is leaving.
+ * @param[in] toRow The row the human is moving to.
+ * @param[in] toCol The column the human is moving to.
+ */
+void Board::moveOccupant(int fromRow, int fromCol, int toRow, int toCol) {
+    occupancy[cellIndex(fromRow, fromCol)]--;
+    occupancy[cellIndex(toRow, toCol)]++;
+}
+
+
+/**
+ * @brief Gives human objects access to the board's AgentStore.
+ * @return The board's AgentStore.
+ */
+AgentStore& Board::getAgents() {
+    return agents;
+}
+
+
+/**
+ * @brief Gives a scavenger the distance field it walks down to reach a goal point.
+ * @param[in] goal The goal point.
+ * @return Steps from every cell to the goal point.
+ */
+const DistanceField& Board::getGoalField(ScavengerGoal goal) {
+    return goalFields[goal];
+}
+
+
+/**
+ * @brief Adds a new agent to the board.
+ * Appends the agent to "agents" and records it in the occupancy index. A scavenger also gets its view in "scavengers", and full health.
+ * @param[in] row The agent's row.
+ * @param[in] col The agent's column.
+ * @param[in] infected Whether the agent is initially infected.
+ * @param[in] role The agent's role.
+ * @return The new agent's id.
+ */
+int Board::addAgent(int row, int col, bool infected, AgentRole role) {
+    int id = agents.add(row, col, infected, role);
+    occupancy[cellIndex(row, col)]++;
+    if (trace.isOpen()) trace.addAgent(row, col, infected, role);
+
+    //New ids are the highest, so the batch stays in order.
+    if (role == ROLE_SCAVENGER) {
+        agents.health[id] = 100;
+        scavengers.push_back(Scavenger(id, this));
     }
 
-    // No problems, so the move is permitted
-    return true;
+    return id;
+}
+
+
+/**
+ * @brief Moves an agent to a new location, keeping the occupancy index in sync.
+ * @param[in] id The agent's id.
+ * @param[in] row The agent's new row.
+ * @param[in] col The agent's new column.
+ */
+void Board::moveAgent(int id, int row, int col) {
+    moveOccupant(agents.row[id], agents.col[id], row, col);
+    agents.row[id] = row;
+    agents.col[id] = col;
+}
+
+
+/**
+ * @brief Changes the role of an agent, keeping its location and infection status.
+ * Only the role in "agents" changes, and any scavenger progress is cleared.
+ * Agents becoming scavengers join the "scavengers" batch, with full health, and count as sent out; agents that stop being scavengers leave it.
+ * @param[in] id The agent's id.
+ * @param[in] role The agent's new role.
+ */
+void Board::changeRole(int id, AgentRole role) {
+    if (agents.role[id] == ROLE_SCAVENGER && role != ROLE_SCAVENGER) {
+        scavengers.erase(scavengers.begin() + scavengerIndex(id));
+    }
+    else if (agents.role[id] != ROLE_SCAVENGER && role == ROLE_SCAVENGER) {
+        agents.health[id] = 100;
+        scavengers.insert(scavengers.begin() + scavengerIndex(id), Scavenger(id, this));
+        numScavengersSent++;
+    }
+
+    agents.role[id] = role;
+    agents.progress[id] = 0;
+    if (trace.isOpen()) trace.role(id, role);
+}
+
+
+/**
+ * @brief Finds where a scavenger is in the "scavengers" batch, by binary search on the agent ids.
+ * @param[in] id The agent's id.
+ * @return The position of the scavenger, or where it would go if the agent is not a scavenger.
+ */
+size_t Board::scavengerIndex(int id) {
+    size_t low = 0;
+    size_t high = scavengers.size();
+    while (low < high) {
+        size_t middle = (low+high)/2;
+        if (scavengers[middle].getId() < id) {
+            low = middle+1;
+        }
+        else {
+            high = middle;
+        }
+    }
+    return low;
 }
 
 /**
  * @brief The function that determines whether two humans are on adjacent squares.
- * @param h1 A pointer to first human object.
- * @param h2 A pointer to second human object.
- * @return Whether or not h1 and h2 are on adjacent squares.
+ * @param first The agent id of the first human.
+ * @param second The agent id of the second human.
+ * @return Whether or not the two humans are on adjacent squares.
  */
-bool Board::isNextTo(Human *h1, Human* h2) {
+bool Board::isNextTo(int first, int second) {
     //Get human location information
-    int h1Row, h1Col;
-    h1->getLocation(h1Row, h1Col);
-    int h2Row, h2Col;
-    h2->getLocation(h2Row, h2Col);
+    int h1Row = agents.row[first];
+    int h1Col = agents.col[first];
+    int h2Row = agents.row[second];
+    int h2Col = agents.col[second];
 
     //Return whether h1 and h2 are on adjacent squares in any direction 
     //(horizontally, vertically, diagonally).
@@ -332,12 +1407,43 @@ bool Board::isNextTo(Human *h1, Human* h2) {
 
 /**
  * @brief Initialize the logical board that governs the background "landscape".
- * Sets all logical board locations to "EMPTY" (see preprocessor macros).
+ * Sizes the logical boards to numRows x numCols (one allocation each) and sets all logical board locations to "EMPTY" (see preprocessor macros).
+ * Also clears the occupancy index, since no humans have been placed yet.
  */
 void Board::initializeLandscapeBoard() {
-    for (int row=0; row<numRows; row++) {
-        for (int col=0; col<numCols; col++) {
-            landscapeBoard[row][col] = EMPTY;
+    landscapeBoard.assign(numRows*numCols, EMPTY);
+    occupancy.assign(numRows*numCols, 0);
+}
+
+
+/**
+ * @brief Sets a cell of the logical landscapeBoard.
+ * Every landscape change goes through here so that the CELL_BLOCKED flag in "occupancy" stays in sync.
+ * Only "EMPTY" and "RESEARCH_FLOOR" cells may be walked on.
+ * @param[in] row The row of the cell.
+ * @param[in] col The column of the cell.
+ * @param[in] marker The landscape marker to place (see preprocessor macros).
+ */
+void Board::setLandscape(int row, int col, char marker) {
+    //Only real changes are recorded; makeResearchFacility() redraws the same walls every time unit.
+    if (trace.isOpen() && landscapeBoard[cellIndex(row, col)] != marker) {
+        trace.landscape(cellIndex(row, col), marker);
+    }
+    landscapeBoard[cellIndex(row, col)] = marker;
+
+    unsigned short wasBlocked = occupancy[cellIndex(row, col)] & CELL_BLOCKED;
+    if (marker == EMPTY || marker == RESEARCH_FLOOR) {
+        occupancy[cellIndex(row, col)] &= ~CELL_BLOCKED;
+    }
+    else {
+        occupancy[cellIndex(row, col)] |= CELL_BLOCKED;
+    }
+
+    //Remember the change for updateGoalFields().
+    if ((occupancy[cellIndex(row, col)] & CELL_BLOCKED) != wasBlocked) {
+        passabilityChanges++;
+        if (goalFieldsReady) {
+            changedCells.push_back(cellIndex(row, col));
         }
     }
 }
@@ -356,7 +1462,7 @@ void Board::makeLandscape() {
 
 /**
  * @brief The primary function for displaying the logical board contents on the screen.
- * Iterates through the landscapeBoard and checks the value at each cell.
+ * Iterates through the landscapeBoard and checks the value at each cell, drawing into "screen".
  * Depending on that value, display a specified character and color.
  * Afterwards, go to the research facility and label it with "VACCINE LAB".
  */
@@ -364,43 +1470,64 @@ void Board::drawLandscape() {
 
     /*
     //Shows where the "gate" and "research facility" goal points are:
-    cout << conio::gotoRowCol(gateRow+1, gateCol+1);
-    cout << conio::bgColor(conio::WHITE) << 'X' << conio::resetAll();
-    cout << conio::gotoRowCol(researchFacilityRow+1, researchFacilityCol+1);
-    cout << conio::bgColor(conio::WHITE) << 'X' << conio::resetAll();
+    screen.put(gateRow, gateCol, 'X', conio::RESET, conio::WHITE);
+    screen.put(researchFacilityRow, researchFacilityCol, 'X', conio::RESET, conio::WHITE);
     */
 
     for (int row=0; row<numRows; row++) {
         for (int col=0; col<numCols; col++) {
             //WALL
-            if (landscapeBoard[row][col] == WALL) {
-                cout << conio::gotoRowCol(row+1,col+1);
-                cout << WALL;
+            if (landscapeBoard[cellIndex(row, col)] == WALL) {
+                screen.put(row, col, WALL, conio::RESET, conio::RESET);
             }
             //FIRST INGREDIENT
-            else if (landscapeBoard[row][col] == FIRST_INGREDIENT) {
-                cout << conio::gotoRowCol(row+1,col+1);
-                cout << conio::bgColor(conio::YELLOW) << conio::fgColor(conio::BLACK) <<FIRST_INGREDIENT << conio::resetAll();
+            else if (landscapeBoard[cellIndex(row, col)] == FIRST_INGREDIENT) {
+                screen.put(row, col, FIRST_INGREDIENT, conio::BLACK, conio::YELLOW);
             }
             //SECOND INGREDIENT
-            else if (landscapeBoard[row][col] == SECOND_INGREDIENT) {
-                cout << conio::gotoRowCol(row+1,col+1);
-                cout << conio::bgColor(conio::MAGENTA) << conio::fgColor(conio::BLACK) << SECOND_INGREDIENT << conio::resetAll();
+            else if (landscapeBoard[cellIndex(row, col)] == SECOND_INGREDIENT) {
+                screen.put(row, col, SECOND_INGREDIENT, conio::BLACK, conio::MAGENTA);
             }
             //RESEARCH FLOOR
-            else if (landscapeBoard[row][col] == RESEARCH_FLOOR) {
-                cout << conio::gotoRowCol(row+1,col+1);
-                cout << conio::bgColor(conio::LIGHT_GRAY) << RESEARCH_FLOOR << conio::resetAll();
+            else if (landscapeBoard[cellIndex(row, col)] == RESEARCH_FLOOR) {
+                screen.put(row, col, RESEARCH_FLOOR, conio::RESET, conio::LIGHT_GRAY);
             }
         }
     }
 
     //Label the research facility with "VACCINE LAB".
-    cout << conio::gotoRowCol(1,numCols-11) << conio::fgColor(conio::BLACK) << conio::bgColor(conio::LIGHT_GRAY);
-    cout << "VACCINE LAB";
+    screen.putText(0, numCols-12, "VACCINE LAB", conio::BLACK, conio::LIGHT_GRAY);
+}
+
 
-    //Make sure cursor is reset back to normal.
-    cout << conio::resetAll() << flush;
+/**
+ * @brief Draws every human at its current row/col location on the screen.
+ * Walks the AgentStore arrays directly, drawing into "screen".
+ * Scavengers are drawn as a yellow 'S'. Infected humans and doctors are drawn as a light red '@'.
+ * Healthy doctors are drawn as a cyan '+', and healthy humans as a light green '@'.
+ */
+void Board::drawHumans() {
+    for (int id=0; id<numHumans; ++id) {
+        int row = agents.row[id];
+        int col = agents.col[id];
+
+        //Scavenger
+        if (agents.role[id] == ROLE_SCAVENGER) {
+            screen.put(row, col, 'S', conio::RESET, conio::YELLOW);
+        }
+        //Infected
+        else if (agents.infected[id]) {
+            screen.put(row, col, '@', conio::RESET, conio::LIGHT_RED);
+        }
+        //Healthy doctor
+        else if (agents.role[id] == ROLE_DOCTOR) {
+            screen.put(row, col, '+', conio::RESET, conio::CYAN);
+        }
+        //Healthy human
+        else {
+            screen.put(row, col, '@', conio::RESET, conio::LIGHT_GREEN);
+        }
+    }
 }
 
 
@@ -414,8 +1541,8 @@ void Board::destroyCity() {
     for (int row=0; row<numRows; row++) {
         for (int col=0; col<numCols; col++) {
             //If WALL, then make it EMPTY.
-            if (landscapeBoard[row][col] == WALL) {
-                landscapeBoard[row][col] = EMPTY;
+            if (landscapeBoard[cellIndex(row, col)] == WALL) {
+                setLandscape(row, col, EMPTY);
             }
         }
     }
@@ -425,7 +1552,7 @@ void Board::destroyCity() {
 
 /**
  * @brief Places humans within the city limits.
- * Adds about a third of the allowed humans to the "humans" array.
+ * Adds about a third of the allowed humans to the board.
  * Only places them within the city, and none of them are infected.
  * Also places numDoctors doctors in the city, and keeps track of the number of doctors placed.
  */
@@ -443,14 +1570,13 @@ void Board::populateCity() {
 
         //Make numDoctors doctors (these are the first to be made).
         if (pos < tempNumDoctors) {
-            humans[pos] = new Doctor(row,col,false,this);
+            addAgent(row, col, false, ROLE_DOCTOR);
             numDoctors++;
         }
         else {
-            // Creates 'Human' objects and sets the array pointers to point at them.
-            // Create and initialize another Human. 
-            // Parameters are row on board, col on board, initially infected, and a pointer to this board object ('this').
-            humans[pos] = new Human(row, col, false, this); 
+            // Creates another healthy human.
+            // Parameters are row on board, col on board, initially infected, and role.
+            addAgent(row, col, false, ROLE_HUMAN); 
         }
     }
 }
@@ -458,7 +1584,7 @@ void Board::populateCity() {
 
 /**
  * @brief Places humans outside the city limits.
- * Fills up the remainder of the "humans" array according to the numHumans variable.
+ * Adds the remainder of the humans to the board according to the numHumans variable.
  * Uses a while(true) loop and "break" statements to determine a random location outside of the city limits.
  * Only places them outside the city, and about a third are set to be infected.
  * The rest are uninfected.
@@ -480,11 +1606,11 @@ void Board::populateOutsideOfCity() {
 
         //Infect first few humans.
         if (pos<=numHumans-int(numHumans/3)) {
-            humans[pos] = new Human(row, col, true, this); 
+            addAgent(row, col, true, ROLE_HUMAN); 
         }
         //Make the rest healthy.
         else {
-            humans[pos] = new Human(row, col, false, this); 
+            addAgent(row, col, false, ROLE_HUMAN); 
         }
     }
 }
@@ -499,8 +1625,8 @@ void Board::populateOutsideOfCity() {
 void Board::makeCityWall() {
     //Make outside wall
     for (int row=0; row<numRows; row++) {
-        landscapeBoard[row][(int(numCols/2))+8] = WALL;
-        landscapeBoard[row][(int(numCols/2))+9] = WALL;
+        setLandscape(row, (int(numCols/2))+8, WALL);
+        setLandscape(row, (int(numCols/2))+9, WALL);
     }
 
     //Initialize variable values based on placement.
@@ -514,18 +1640,21 @@ void Board::makeCityWall() {
 /** 
  * @brief Makes the research facility, marking it on the logical landscapeBoard.
  * Creates portions of doubly thick walls at the upper right corner of the board.
- * Uses the marker "WALL".
+ * Uses the marker "WALL". The board must be at least MIN_ROWS by MIN_COLS, so that the facility lies wholly inside the city.
  * When done, it initializes the values of researchFacilityEndingRow, researchFacilityStartingCol, researchFacilityRow, and researchFacilityCol. 
  */
 void Board::makeResearchFacility() {
+    //The facility's left wall must stand clear of the city wall, and its bottom wall on the board.
+    assert(numCols-15 > cityStartingColumn && numRows >= MIN_ROWS);
+
     //Make research facility
     for (int row=0; row<3; row++) {
-        landscapeBoard[row][numCols-15] = WALL;
-        landscapeBoard[row][numCols-14] = WALL;
+        setLandscape(row, numCols-15, WALL);
+        setLandscape(row, numCols-14, WALL);
     }
     for (int col=numCols-5; col<numCols; col++) {
-        landscapeBoard[5][col] = WALL;
-        landscapeBoard[6][col] = WALL;
+        setLandscape(5, col, WALL);
+        setLandscape(6, col, WALL);
     }
 
     //Initialize variable values based on placement.
@@ -550,13 +1679,13 @@ void Board::makeTwoVaccineIngredients() {
     while (true) {
         row = random() % numRows; // row will be in range(0, numRows-1)
         col = random() % numCols; // col will be in range(0, numCols-1)
-        if ((row > cityEndingRow+2 || col < cityStartingColumn-2) && landscapeBoard[row][col] == EMPTY) {
+        if ((row > cityEndingRow+2 || col < cityStartingColumn-2) && landscapeBoard[cellIndex(row, col)] == EMPTY) {
             break;
         }
     }
 
     //Initialize variable values based on placement.
-    landscapeBoard[row][col] = FIRST_INGREDIENT;
+    setLandscape(row, col, FIRST_INGREDIENT);
     firstIngredientRow = row;
     firstIngredientCol = col;
 
@@ -565,13 +1694,13 @@ void Board::makeTwoVaccineIngredients() {
     while (true) {
         row = random() % numRows;       // row will be in range(0, numRows-1)
         col = random() % numCols;  // col will be in range(0, numCols-1)
-        if ((row > cityEndingRow+2 || col < cityStartingColumn-2) && landscapeBoard[row][col] == EMPTY) {
+        if ((row > cityEndingRow+2 || col < cityStartingColumn-2) && landscapeBoard[cellIndex(row, col)] == EMPTY) {
             break;
         }
     }
 
     //Initialize variable values based on placement.
-    landscapeBoard[row][col] = SECOND_INGREDIENT;
+    setLandscape(row, col, SECOND_INGREDIENT);
     secondIngredientRow = row;
     secondIngredientCol = col;
 }
@@ -583,8 +1712,8 @@ void Board::makeTwoVaccineIngredients() {
  */
 void Board::openCityGate() {
     for (int row=(int(numRows/2))+1; row>(int(numRows/2))-4; row--) {
-        landscapeBoard[row][(int(numCols/2))+8] = EMPTY;
-        landscapeBoard[row][(int(numCols/2))+9] = EMPTY;
+        setLandscape(row, (int(numCols/2))+8, EMPTY);
+        setLandscape(row, (int(numCols/2))+9, EMPTY);
     }
 }
 
@@ -595,8 +1724,8 @@ void Board::openCityGate() {
  */
 void Board::closeCityGate() {
     for (int row=(int(numRows/2))+1; row>(int(numRows/2))-4; row--) {
-        landscapeBoard[row][(int(numCols/2))+8] = WALL;
-        landscapeBoard[row][(int(numCols/2))+9] = WALL;
+        setLandscape(row, (int(numCols/2))+8, WALL);
+        setLandscape(row, (int(numCols/2))+9, WALL);
     }
 }
 
@@ -609,45 +1738,118 @@ void Board::closeCityGate() {
 void Board::markResearchFacility() {
     for (int row=0; row<=researchFacilityEndingRow; row++) {
         for (int col=researchFacilityStartingCol; col<numCols; col++) {
-            landscapeBoard[row][col] = RESEARCH_FLOOR;
+            setLandscape(row, col, RESEARCH_FLOOR);
         }
     }
 }
 
 
 /**
- * @brief Randomly selects a human within the city to be a scavenger.
- * Iterate through the "humans" board and select a human based on certain critera.
- * Criteria: 1) Is not infected, 2) Is a human (not a doctor), 3) Is within the city.
- * Changes selected human to scavenger by deleting humans[pos] and replacing it with a pointer to a Scavenger object.
- * Afterwards, give the scavenger all the necessary information for pathfinding.
+ * @brief Randomly selects "numScavengers" humans within the city to be scavengers.
+ * Pick random agents and select them based on certain critera.
+ * Criteria: 1) Is not infected, 2) Is a human (not a doctor or a scavenger already), 3) Is within the city.
+ * If too few humans meet the criteria, only those are selected; with none, the scavengers count as lost right away.
+ * Changes each selected human to a scavenger with changeRole(), which adds it to the "scavengers" batch.
+ * Afterwards, make sure the distance fields the scavengers walk by are built with buildGoalFields().
  */
 void Board::selectScavenger() {
     int pos;
     int row, col;
-    while (true) {
-        pos = random() % numHumans;
-        if (humans[pos]->isInfected()==false) {
-            if (humans[pos]->getObjectType()=="Human") {
-                humans[pos]->getLocation(row,col);
-                if (isWithinCity(row,col)) {
-                    scavengerPos = pos;
-                    delete humans[scavengerPos];
-                    //Make a scavenger.
-                    humans[scavengerPos] = new Scavenger(row,col,false,this);
-                    //Communicate first ingredient coordinates.
-                    humans[scavengerPos]->setFirstIngredientRowCol(firstIngredientRow,firstIngredientCol);
-                    //Communicate second ingredient coordinates.
-                    humans[scavengerPos]->setSecondIngredientRowCol(secondIngredientRow,secondIngredientCol);
-                    //Communicate gate goal point coordinates.
-                    humans[scavengerPos]->setGateRowCol(gateRow,gateCol);
-                    //Communicate research facility goal point coordinates.
-                    humans[scavengerPos]->setResearchFacilityRowCol(researchFacilityRow, researchFacilityCol);
-                    break;
+
+    //Count who qualifies, so that the random search below always ends.
+    int candidates = 0;
+    for (pos=0; pos<numHumans; pos++) {
+        candidates += !agents.infected[pos] && agents.role[pos]==ROLE_HUMAN && isWithinCity(agents.row[pos], agents.col[pos]);
+    }
+    scavengers.reserve(scavengers.size() + min(numScavengers, candidates));
+
+    for (int sent=0; sent<numScavengers && candidates>0; sent++, candidates--) {
+        while (true) {
+            pos = random() % numHumans;
+            if (agents.infected[pos]==false) {
+                if (agents.role[pos]==ROLE_HUMAN) {
+                    row = agents.row[pos];
+                    col = agents.col[pos];
+                    if (isWithinCity(row,col)) {
+                        //Make a scavenger.
+                        changeRole(pos, ROLE_SCAVENGER);
+                        //Map the way to the goal points.
+                        buildGoalFields();
+                        break;
+                    }
                 }
             }
         }
-    } 
+    }
+}
+
+
+/**
+ * @brief Builds the distance fields that scavengers walk down to every goal point, unless they are built already.
+ * Call whenever an agent becomes a scavenger. From then on setLandscape() and updateGoalFields() keep the fields current.
+ */
+void Board::buildGoalFields() {
+    if (! goalFieldsReady) {
+        int goalRows[NUM_GOALS] = {gateRow, firstIngredientRow, secondIngredientRow, researchFacilityRow};
+        int goalCols[NUM_GOALS] = {gateCol, firstIngredientCol, secondIngredientCol, researchFacilityCol};
+
+        goalFields.assign(NUM_GOALS, DistanceField(numRows, numCols));
+        if (fieldCache != NULL) {
+            fetchGoalFields();
+        }
+        else {
+            for (int goal=0; goal<NUM_GOALS; goal++) {
+                goalFields[goal].build(goalRows[goal], goalCols[goal], occupancy);
+            }
+        }
+        changedCells.clear();
+        goalFieldsReady = true;
+    }
+}
+
+
+/**
+ * @brief Repairs the goal distance fields after walls were opened or closed.
+ * openCityGate(), closeCityGate(), destroyCity(), picking up an ingredient, and the research facility walls all change cells through setLandscape(),
+ * which lists the cells whose passability changed. Only the distances those cells affect are recomputed.
+ */
+void Board::updateGoalFields() {
+    if (! goalFieldsReady || changedCells.empty()) return;
+
+    //Picking up or dropping an ingredient is a small repair. Anything else (the city wall falling) is a new layout, which the cache may already know.
+    bool onlyIngredients = true;
+    for (size_t i=0; i<changedCells.size() && onlyIngredients; i++) {
+        onlyIngredients = changedCells[i] == cellIndex(firstIngredientRow, firstIngredientCol) || changedCells[i] == cellIndex(secondIngredientRow, secondIngredientCol);
+    }
+
+    if (fieldCache != NULL && ! onlyIngredients) {
+        fetchGoalFields();
+    }
+    else {
+        for (int goal=0; goal<NUM_GOALS; goal++) {
+            goalFields[goal].update(changedCells, occupancy);
+        }
+    }
+    changedCells.clear();
+}
+
+
+/**
+ * @brief Takes every goal distance field from "fieldCache", which keeps them for the layout without the ingredients,
+ * and repairs each for the ingredient cells, so they match fields built on this board.
+ */
+void Board::fetchGoalFields() {
+    int goalRows[NUM_GOALS] = {gateRow, firstIngredientRow, secondIngredientRow, researchFacilityRow};
+    int goalCols[NUM_GOALS] = {gateCol, firstIngredientCol, secondIngredientCol, researchFacilityCol};
+
+    vector<int> ingredientCells;
+    ingredientCells.push_back(cellIndex(firstIngredientRow, firstIngredientCol));
+    ingredientCells.push_back(cellIndex(secondIngredientRow, secondIngredientCol));
+
+    for (int goal=0; goal<NUM_GOALS; goal++) {
+        fieldCache->fetch(goalRows[goal], goalCols[goal], numRows, numCols, occupancy, ingredientCells, goalFields[goal]);
+        goalFields[goal].update(ingredientCells, occupancy);
+    }
 }
 
 
@@ -686,51 +1888,172 @@ bool Board::isWithinResearchFacility(int row, int col) {
 
 
 /**
- * @brief Checks the status of the scavenger and updates values accordingly.
- * Uses the member function "isNextToAGoal(goalRow,goalCol)" to see if the scavenger has reached a certain goal point.
+ * @brief Chooses the goal point a scavenger heads to next.
+ * A scavenger fetches the first ingredient and then the second, skipping any that another scavenger already carries or delivered,
+ * and then brings what it carries to the research facility. It leaves (and, once nothing is left to fetch, comes back) through the gate.
+ * Every scavenger with the same goal walks down the same distance field, so the cost does not grow with the number of scavengers.
+ * @param[in] id The agent id of the scavenger.
+ * @param[out] goal The goal point to head to.
+ * @return false if the scavenger carries nothing and nothing is left for it to fetch.
+ */
+bool Board::chooseScavengerGoal(int id, ScavengerGoal& goal) {
+    unsigned char progress = agents.progress[id];
+
+    if (! (progress & HAS_FIRST_INGREDIENT) && firstIngredientCarrier == INGREDIENT_ON_MAP) {
+        goal = GOAL_FIRST_INGREDIENT;
+    }
+    else if (! (progress & HAS_SECOND_INGREDIENT) && secondIngredientCarrier == INGREDIENT_ON_MAP) {
+        goal = GOAL_SECOND_INGREDIENT;
+    }
+    else if (progress & (HAS_FIRST_INGREDIENT | HAS_SECOND_INGREDIENT)) {
+        goal = GOAL_RESEARCH_FACILITY;
+    }
+    else {
+        return false;
+    }
+
+    if (! (progress & REACHED_GATE)) {
+        goal = GOAL_GATE;
+    }
+    return true;
+}
+
+
+/**
+ * @brief Checks the status of every scavenger and updates values accordingly.
+ * Uses the member function "isNextToAGoal(id,goalRow,goalCol)" to see if a scavenger has reached a certain goal point.
  * If so, tell scavenger about this, allowing the scavenger to move on to the next goal point.
+ * Scavengers are checked in order of their ids, so when two reach an ingredient in the same time unit the lower id takes it.
  */
 void Board::checkOnScavenger() {
 
-    if (scavengerPos != -1) {
-        
+    for (size_t s=0; s<scavengers.size(); s++) {
+        Scavenger& scavenger = scavengers[s];
+        int id = scavenger.getId();
+        unsigned char progressBefore = agents.progress[id];
+
         //Scavenger reached gate.
-        if (isNextToAGoal(gateRow,gateCol)) {
-            humans[scavengerPos]->setHasReachedGate(true); 
+        if (isNextToAGoal(id, gateRow, gateCol)) {
+            scavenger.setHasReachedGate(true);
+        }
+
+        //Scavenger reached first ingredient, and nobody took it yet.
+        else if (firstIngredientCarrier == INGREDIENT_ON_MAP && isNextToAGoal(id, firstIngredientRow, firstIngredientCol)) {
+            scavenger.setHasFirstIngredient(true);
+            firstIngredientCarrier = id;
+            setLandscape(firstIngredientRow, firstIngredientCol, EMPTY);
+        }
+
+        //Scavenger reached second ingredient, and nobody took it yet.
+        else if (secondIngredientCarrier == INGREDIENT_ON_MAP && isNextToAGoal(id, secondIngredientRow, secondIngredientCol)) {
+            scavenger.setHasSecondIngredient(true);
+            secondIngredientCarrier = id;
+            setLandscape(secondIngredientRow, secondIngredientCol, EMPTY);
+        }
+
+        //Scavenger brought ingredients to the research facility.
+        else if ((progressBefore & (HAS_FIRST_INGREDIENT | HAS_SECOND_INGREDIENT)) && isNextToAGoal(id, researchFacilityRow, researchFacilityCol)) {
+            scavenger.setHasReachedResearchFacility(true);
+            deliverIngredients(id);
         }
 
-        //Scavenger reached first ingredient.
-        else if (isNextToAGoal(firstIngredientRow,firstIngredientCol)) {
-            humans[scavengerPos]->setHasFirstIngredient(true); 
-            landscapeBoard[firstIngredientRow][firstIngredientCol] = EMPTY;
+        //Once both ingredients are taken, the scavenger that took the last one heads back through the gate.
+        bool tookIngredient = agents.progress[id] & ~progressBefore & (HAS_FIRST_INGREDIENT | HAS_SECOND_INGREDIENT);
+        if (tookIngredient && firstIngredientCarrier != INGREDIENT_ON_MAP && secondIngredientCarrier != INGREDIENT_ON_MAP) {
+            scavenger.setHasReachedGate(false);
         }
 
-        //Scavenger reached second ingredient.
-        else if (isNextToAGoal(secondIngredientRow,secondIngredientCol) && humans[scavengerPos]->getHasFirstIngredient()) {
-            humans[scavengerPos]->setHasSecondIngredient(true); 
-            humans[scavengerPos]->setHasReachedGate(false); 
-            landscapeBoard[secondIngredientRow][secondIngredientCol] = EMPTY;
+        if (trace.isOpen() && agents.progress[id] != progressBefore) {
+            trace.progress(id, agents.progress[id]);
         }
+    }
+}
+
+
+/**
+ * @brief Marks the ingredients a scavenger carries as delivered to the research facility.
+ * @param[in] id The agent id of the scavenger.
+ */
+void Board::deliverIngredients(int id) {
+    if (firstIngredientCarrier == id) {
+        firstIngredientCarrier = INGREDIENT_DELIVERED;
+    }
+    if (secondIngredientCarrier == id) {
+        secondIngredientCarrier = INGREDIENT_DELIVERED;
+    }
+}
 
-        //Scavenger reached research facility.
-        else if (isNextToAGoal(researchFacilityRow,researchFacilityCol) && humans[scavengerPos]->getHasFirstIngredient() && humans[scavengerPos]->getHasSecondIngredient()) {
-            humans[scavengerPos]->setHasReachedResearchFacility(true); 
+
+/**
+ * @brief Puts an ingredient back on the map after the scavenger carrying it died.
+ * The ingredient goes back where it was found, unless someone stands there now; then it goes on the free cell nearest to the
+ * dead carrier, taking the rings of cells around it one at a time, each in row-major order. Only if the whole board is taken does
+ * it go back where it was found anyway, under whoever stands there.
+ * @param[in] marker FIRST_INGREDIENT or SECOND_INGREDIENT.
+ * @param[in] id The agent id of the dead carrier.
+ */
+void Board::dropIngredient(char marker, int id) {
+    int row = (marker == FIRST_INGREDIENT) ? firstIngredientRow : secondIngredientRow;
+    int col = (marker == FIRST_INGREDIENT) ? firstIngredientCol : secondIngredientCol;
+
+    if (occupancy[cellIndex(row, col)] != 0) {
+        int carrierRow = agents.row[id];
+        int carrierCol = agents.col[id];
+        bool found = false;
+        for (int ring=1; ring<max(numRows, numCols) && ! found; ring++) {
+            for (int r=max(carrierRow-ring, 0); r<=min(carrierRow+ring, numRows-1) && ! found; r++) {
+                for (int c=max(carrierCol-ring, 0); c<=min(carrierCol+ring, numCols-1) && ! found; c++) {
+                    bool onRing = abs(r-carrierRow) == ring || abs(c-carrierCol) == ring;
+                    if (onRing && landscapeBoard[cellIndex(r, c)] == EMPTY && occupancy[cellIndex(r, c)] == 0) {
+                        row = r;
+                        col = c;
+                        found = true;
+                    }
+                }
+            }
         }
     }
+
+    placeIngredient(marker, row, col);
+}
+
+
+/**
+ * @brief Marks an ingredient on the map, and keeps its coordinates and goal field in step with where it is.
+ * If the ingredient moved, the scavengers' distance field to it is built again for the new cell.
+ * @param[in] marker FIRST_INGREDIENT or SECOND_INGREDIENT.
+ * @param[in] row The row of the cell to place it on.
+ * @param[in] col The column of the cell to place it on.
+ */
+void Board::placeIngredient(char marker, int row, int col) {
+    int& ingredientRow = (marker == FIRST_INGREDIENT) ? firstIngredientRow : secondIngredientRow;
+    int& ingredientCol = (marker == FIRST_INGREDIENT) ? firstIngredientCol : secondIngredientCol;
+    bool moved = row != ingredientRow || col != ingredientCol;
+
+    ingredientRow = row;
+    ingredientCol = col;
+    setLandscape(row, col, marker);
+
+    if (moved && goalFieldsReady) {
+        ScavengerGoal goal = (marker == FIRST_INGREDIENT) ? GOAL_FIRST_INGREDIENT : GOAL_SECOND_INGREDIENT;
+        goalFields[goal].build(row, col, occupancy);
+    }
 }
 
 
 /**
- * @brief Checks if scavenger is within 1 space of a specified goal point.
+ * @brief Checks if a scavenger is within 1 space of a specified goal point.
+ * @param[in] id The agent id of the scavenger.
  * @param[in] goalRow The row of a goal point.
  * @param[in] goalCol The column of a goal point.
- * @return If scavenger is within 1 space of the specified goal or not.
+ * @return If the scavenger is within 1 space of the specified goal or not.
  */
-bool Board::isNextToAGoal(int goalRow, int goalCol) {
+bool Board::isNextToAGoal(int id, int goalRow, int goalCol) {
     int scavengerRow, scavengerCol;
 
     //Define scavengerRow and scavengerCol
-    humans[scavengerPos]->getLocation(scavengerRow, scavengerCol);
+    scavengerRow = agents.row[id];
+    scavengerCol = agents.col[id];
 
     return abs(scavengerRow-goalRow)<=1 && abs(scavengerCol-goalCol)<=1;   
 }
@@ -739,7 +2062,7 @@ bool Board::isNextToAGoal(int goalRow, int goalCol) {
 /**
  * @brief Updates the vaccine research progress numerical value.
  * If the infection has worsened (near end of game), then research stops.
- * If the scavenger has retrieved both the ingredients and has made it back to the research facility, increase research progress by a lot.
+ * If the scavengers have delivered both the ingredients to the research facility, increase research progress by a lot.
  * Otherwise, increase research progress by a random, small amount.
  * If research progress goes beyond 100, set it to 100 (cap it at 100).
  */
@@ -747,21 +2070,13 @@ void Board::updateResearchProgress() {
 
     if (! infectionWorsened) {
 
-        //If there's a scavenger.
-        if (scavengerPos != -1) {
-
-            int scavengerRow, scavengerCol;
-            //Get scavenger's position.
-            humans[scavengerPos]->getLocation(scavengerRow, scavengerCol);
-
-            //If scavenger has both ingredients and is in research facility.
-            if (humans[scavengerPos]->getHasFirstIngredient() && humans[scavengerPos]->getHasSecondIngredient() && isWithinResearchFacility(scavengerRow, scavengerCol)) {
-                vaccineResearchProgress += rand()%10;
-            }
+        //If both ingredients are in the research facility.
+        if (firstIngredientCarrier == INGREDIENT_DELIVERED && secondIngredientCarrier == INGREDIENT_DELIVERED) {
+            vaccineResearchProgress += random()%10;
         }
 
         //Based on a random number, increase vaccineResearchProgress.
-        int randNum = rand()%5;
+        int randNum = random()%5;
         switch (randNum) {
             case 0:
                 vaccineResearchProgress += 0.8;
@@ -794,7 +2109,7 @@ void Board::updateResearchProgress() {
  * If its health goes below 0, call "destroyCity()" and set health to 0 (cap it at 0).
  */
 void Board::updateCityWallHealth() {
-    int randNum = rand()%4;
+    int randNum = random()%4;
     switch (randNum) {
         case 0:
             cityWallHealth -= 2;
@@ -823,7 +2138,7 @@ void Board::updateCityWallHealth() {
 /**
  * @brief Print out useful, neat statistics relating to simulation status.
  * Based on a variety of simulation status variables and currentTime, set "gameNote" accordingly.
- * Print out various statistics along with gameNote.
+ * Print out various statistics along with gameNote, below the board on "screen".
  * @param[in] currentTime The current simulation time tick.
  */
 void Board::printStatistics(int currentTime) {
@@ -835,20 +2150,20 @@ void Board::printStatistics(int currentTime) {
     else if (currentTime < 30) {
         gameNote = "Vaccine ingredients are needed!";
     }
-    //Time < 45 and there's a scavenger.
-    else if (currentTime < 45 && scavengerPos != -1) {
-        gameNote = "A scavenger has been selected!";
+    //Time < 45 and scavengers were sent out.
+    else if (currentTime < 45 && numScavengersSent > 0) {
+        gameNote = (numScavengersSent > 1) ? "Scavengers have been selected!" : "A scavenger has been selected!";
     }
-    //There's a scavenger and it has reached the first ingredient.
-    if (scavengerPos != -1 && humans[scavengerPos]->getHasFirstIngredient()) {
-        gameNote = "The first ingredient has been grabbed!";
+    //A scavenger has reached one of the ingredients.
+    if (firstIngredientCarrier != INGREDIENT_ON_MAP || secondIngredientCarrier != INGREDIENT_ON_MAP) {
+        gameNote = (firstIngredientCarrier != INGREDIENT_ON_MAP) ? "The first ingredient has been grabbed!" : "The second ingredient has been grabbed!";
     }
-    //There's a scavenger and it has reached the second ingredient.
-    if (scavengerPos != -1 && humans[scavengerPos]->getHasSecondIngredient()) {
+    //Scavengers have reached both ingredients.
+    if (firstIngredientCarrier != INGREDIENT_ON_MAP && secondIngredientCarrier != INGREDIENT_ON_MAP) {
         gameNote = "Both ingredients have been grabbed!";
     }
-    //There's a scavenger and it has reached the research facility.
-    if (scavengerPos != -1 && humans[scavengerPos]->getHasReachedResearchFacility()) {
+    //Both ingredients have reached the research facility.
+    if (firstIngredientCarrier == INGREDIENT_DELIVERED && secondIngredientCarrier == INGREDIENT_DELIVERED) {
         gameNote = "Ingredients applied! Vaccine research accelerated!";
     }
     //If vaccine reached 100% and was applied.
@@ -863,89 +2178,97 @@ void Board::printStatistics(int currentTime) {
     else if (cityWallHealth == 0) {
         gameNote = "The city wall has crumbled!";
     }
-    //If scavenger is dead.
-    else if (scavengerHealth == 0) {
-        gameNote = "The scavenger has perished!";
+    //If every scavenger is dead (or none could be sent).
+    else if (currentTime >= 35 && scavengers.empty()) {
+        gameNote = (numScavengersSent > 1) ? "The scavengers have perished!" : "The scavenger has perished!";
     }
-    //Time >= 385.
-    if (currentTime >= 385) {
+    //Within 15 time units of the limit (385 by default).
+    if (currentTime >= tickLimit-15) {
         gameNote = "The infected WIN!";
     }
 
     //Print game note.
-    cout << conio::gotoRowCol(numRows+3, 1)
-         << "   -- " << gameNote << " --   ";
+    screen.putText(numRows+2, 0, "   -- " + gameNote + " --   ", conio::RESET, conio::RESET);
 
     //Print vaccine percentage.
-    cout << conio::gotoRowCol(numRows+4,1)
-         << "Vaccine:" << vaccineResearchProgress << "%";
+    ostringstream line;
+    line << "Vaccine:" << vaccineResearchProgress << "%";
+    screen.putText(numRows+3, 0, line.str(), conio::RESET, conio::RESET);
 
     //Print time info and various object counts.
-    cout << conio::gotoRowCol(numRows+5, 1) 
-         << "Time:" << currentTime 
+    line.str("");
+    line << "Time:" << currentTime 
          << " | Humans:" << numHumans
          << " | Doctors:" << numDoctors
          << " | Infected:" << numInfected;
+    screen.putText(numRows+4, 0, line.str(), conio::RESET, conio::RESET);
 
     //Print city wall health.
-    cout << conio::gotoRowCol(numRows+6, 1)
-         << "CityWallHealth:" << cityWallHealth << "%";
-
-    //If there's a scavenger, print scavenger health.
-    if (scavengerPos != -1) {
-        cout << conio::gotoRowCol(numRows+7, 1)
-        << "ScavengerHealth:" << scavengerHealth << "%";
+    line.str("");
+    line << "CityWallHealth:" << cityWallHealth << "%";
+    screen.putText(numRows+5, 0, line.str(), conio::RESET, conio::RESET);
+
+    //If there's a scavenger, print scavenger health. With several, print how many are still alive.
+    if (numScavengersSent == 1) {
+        line.str("");
+        line << "ScavengerHealth:" << (scavengers.empty() ? 0 : int(agents.health[scavengers[0].getId()])) << "%";
+        screen.putText(numRows+6, 0, line.str(), conio::RESET, conio::RESET);
+    }
+    else if (numScavengersSent > 1) {
+        line.str("");
+        line << "Scavengers:" << scavengers.size() << "/" << numScavengersSent << " alive";
+        screen.putText(numRows+6, 0, line.str(), conio::RESET, conio::RESET);
     }
-
-    //Flush it all out there to the screen.
-    cout << flush;
 }
 
 
 /**
  * @brief Implement the vaccine to cure all infected humans.
  * If research progress has reached 100%, cure all humans.
- * Iterate through all humans in "humans" array and call "setUnInfected()".
+ * Iterate through all agents and clear their infected flag.
  * Finally, set boolean value of "vaccineApplied" to true.
  */
 void Board::applyVaccine() {
     if (! vaccineApplied) {
         //Set all humans to uninfected
         for (int pos=0; pos<numHumans; pos++) {
-            humans[pos]->setUnInfected();
+            agents.infected[pos] = false;
         }
+        numInfected = 0;
         vaccineApplied = true;
+        if (trace.isOpen()) trace.vaccineApplied();
     }
 }
 
 
 /**
  * @brief Creates 2x the amount of infected humans so that all remaining humans will become infected much quicker.
- * Adds infected humans to "humans" array and updates "numHumans" value.
+ * Adds WORSENED_INFECTED_COUNT infected humans to the board (room for them was reserved by the constructor) and updates "numHumans" value.
  * Finally, sets boolean value of "infectionWorsened" to true.
  */ 
 void Board::makeInfectionWorse() {
     if (! infectionWorsened) {
         int row, col;
 
+        if (trace.isOpen()) trace.infectionWorsened();
+
         //Remove doctors.
         for (int pos=0; pos<numHumans; pos++) {
-            if (humans[pos]->getObjectType() == "Doctor") {
-                humans[pos]->getLocation(row,col);
-                delete humans[pos];
-                humans[pos] = new Human(row,col,false,this);
+            if (agents.role[pos] == ROLE_DOCTOR) {
+                changeRole(pos, ROLE_HUMAN);
             }
         }
 
         //Place more infected.
-        for (int pos=numHumans; pos < numHumans+30; pos++) {
+        for (int pos=numHumans; pos < numHumans+WORSENED_INFECTED_COUNT; pos++) {
             row = random() % numRows; //row will be in range(0, numRows-1)
             col = random() % numCols; //col will be in range(0, numCols-1)
-            humans[pos] = new Human(row, col, true, this); 
+            addAgent(row, col, true, ROLE_HUMAN); 
         }
 
-        //Update numHumans.
-        numHumans+=30;
+        //Update numHumans and numInfected.
+        numHumans+=WORSENED_INFECTED_COUNT;
+        numInfected+=WORSENED_INFECTED_COUNT;
 
         infectionWorsened = true;
     }
@@ -953,8 +2276,31 @@ void Board::makeInfectionWorse() {
 
 
 /**
- * @brief Helper to return a random float.
+ * @brief Helper to return a random number from this board's own generator.
+ * Every random decision in the simulation (the board's and its humans') goes through here, so boards never share random state
+ * and several boards can run at once on different threads.
+ * @return A random number in the range [0, 2^31-1].
  */ 
 int Board::random() {
-	return rand();
+	return generator.nextInt();
+}
+
+
+/**
+ * @brief Seeds this board's generator.
+ * Two boards given the same seed and scenario play out the same game. Boards start out seeded with 0.
+ * @param[in] seed The seed.
+ */
+void Board::setSeed(uint64_t seed) {
+    generator.seed(seed);
+    startingSeed = seed;
+}
+
+
+/**
+ * @brief Makes this board draw from the given stream, such as one handed out by Random::split().
+ * @param[in] stream The generator to copy.
+ */
+void Board::setRandom(const Random& stream) {
+    generator = stream;
 }
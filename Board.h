@@ -19,10 +19,67 @@
 class Board;
 
 #include "Human.h"
+#include "Scavenger.h"
+#include "AgentStore.h"
+#include "NeighborGrid.h"
+#include "InfectionBitboard.h"
+#include "DistanceField.h"
+#include "FieldCache.h"
+#include "Random.h"
+#include "Screen.h"
+#include "FrameExchange.h"
+#include "WorkerPool.h"
+#include "Checkpoint.h"
+#include "Trace.h"
+#include "TraceReader.h"
+#include <atomic>
 #include <string>
+#include <thread>
+#include <vector>
 
 using namespace std;
 
+/**
+ * @brief How a run ended.
+ */
+enum GameOutcome {
+    OUTCOME_VACCINE,        // Vaccine reached 100% and was applied. Humans win.
+    OUTCOME_INFECTION,      // Infection was worsened after the scavenger and city wall fell. Infected win.
+    OUTCOME_TIME_LIMIT,     // Neither happened before the time limit. Infected win.
+    OUTCOME_IN_PROGRESS     // The run was stopped before the time limit still undecided, as a replay can be. Nobody has won yet.
+};
+
+/**
+ * @brief How the outcome of a run was settled.
+ */
+enum OutcomeReason {
+    REASON_VACCINE_APPLIED,     // Vaccine reached 100% and cured everyone.
+    REASON_INFECTION_WORSENED,  // The city wall and every scavenger fell after time 150, and the infection was worsened.
+    REASON_OUT_OF_TIME,         // Neither could happen any more before the time limit.
+    REASON_TIME_LIMIT,          // The run reached the time limit still undecided.
+    REASON_IN_PROGRESS          // The run was stopped before the time limit still undecided.
+};
+
+/**
+ * @brief End-of-run statistics returned by Board::getSummary().
+ */
+struct RunSummary {
+    GameOutcome outcome;            // How the run ended
+    OutcomeReason reason;           // How the outcome was settled
+    int decidedTick;                // Time unit the outcome was settled at
+    int endTick;                    // Time unit the run stopped at
+    int numHumans;                  // Final number of humans (including doctors and scavengers)
+    int numInfected;                // Final number of infected
+    float vaccineResearchProgress;  // Final vaccine research progress (%)
+    int cityWallHealth;             // Final city wall health (%)
+};
+
+//Machine-readable name for an outcome: "vaccine", "infection", "time_limit", or "in_progress".
+const char* outcomeName(GameOutcome outcome);
+
+//Machine-readable name for a reason: "vaccine_applied", "infection_worsened", "out_of_time", "time_limit", or "in_progress".
+const char* reasonName(OutcomeReason reason);
+
 /**
  * @class Board
  * @brief The Board class declaration.
@@ -30,32 +87,152 @@ using namespace std;
 class Board {
     public:
     Board(int numRows, int numCols, int numHumans, int numDoctors); 
-    ~Board();                 
+    virtual ~Board();                 
 
     //Main function that runs the simulation.
     void run();
 
+    //Run options. Headless boards never draw or sleep.
+    void setHeadless(bool isHeadless);
+    void setTickLimit(int limit);
+
+    //Number of scavengers sent out for the vaccine ingredients at time 35 (1 by default).
+    void setNumScavengers(int count);
+
+    //Movement rule. 0 (the default) moves humans one after another; otherwise every human chooses its move at once
+    //and conflicts are settled by priority, on this many threads. Results do not depend on the thread count.
+    void setMoveThreads(int numThreads);
+
+    //Infection rule. By default adjacent pairs of humans meet one pair after another, so an infection can pass along a chain
+    //of humans within one time unit. With bitboards, everyone is infected or healed at once from where the infected and
+    //doctors stood at the start of the time unit, 64 cells at a time.
+    void setBitboardInfection(bool enabled);
+
+    //Speed options for boards that are not headless. The simulation and the display run on separate threads.
+    void setTickDelay(int microseconds);
+    void setFrameRate(int framesPerSecond);
+
+    //How the last run ended.
+    RunSummary getSummary();
+
+    //Checkpoints. A restored board continues the checkpointed run exactly; run() then skips setting up a new game.
+    void captureCheckpoint(Checkpoint& checkpoint);
+    void restoreCheckpoint(const Checkpoint& checkpoint);
+
+    //Write a checkpoint to "path" every "everyTicks" time units while running.
+    void setCheckpointFile(const string& path, int everyTicks);
+
+    //Record every move, infection, heal, role change, and scavenger milestone of the run to "path",
+    //with a keyframe of the whole state every "keyframeEvery" time units for seeking.
+    void setTraceFile(const string& path, int keyframeEvery);
+
+    //Play back a recorded run from time unit "fromTime" to "toTime", "timeUnitsPerFrame" time units per frame (negative to play backward).
+    //The board must have the trace's rows and columns. Headless boards only seek to "toTime".
+    void replay(TraceReader& reader, int fromTime, int toTime, int timeUnitsPerFrame);
+
+    //Put the board in the state a recorded run had after time unit "time". Returns false if the trace does not reach it.
+    bool seekTrace(TraceReader& reader, int time);
+
+    //Random numbers for the board and its humans, from the board's own generator.
+    int random();
+    void setSeed(uint64_t seed);
+    void setRandom(const Random& stream);
+
     // Function that lets human objects know whether a move is okay.
     bool tryMove(int row, int col); 
 
-    //Setting maximum human count and board dimensions.
-    //Used to initialize the logical boards.
-    static const int MAX_HUMAN_COUNT = 100; 
-    static const int MAX_NUM_ROWS = 20;
-    static const int MAX_NUM_COLS = 80;
+    //Function that keeps the occupancy index in sync when a human moves.
+    void moveOccupant(int fromRow, int fromCol, int toRow, int toCol);
+
+    //Gives human objects access to the agent data they view.
+    AgentStore& getAgents();
+
+    //Steps from every cell to a scavenger goal point, around the walls. Only valid once there has been a scavenger.
+    //Every scavenger heading to the same goal point walks down the same field.
+    const DistanceField& getGoalField(ScavengerGoal goal);
+
+    //Take the goal distance fields from "cache" (not owned), shared with other boards of the same scenario, instead of building them.
+    //The game is the same either way. Boards sharing a cache must not run at the same time.
+    void setFieldCache(FieldCache* cache);
+
+    //Which goal point scavenger "id" should head to next. Returns false if it has nothing left to fetch or deliver.
+    bool chooseScavengerGoal(int id, ScavengerGoal& goal);
+
+    //Number of infected humans added by makeInfectionWorse().
+    //The AgentStore reserves room for them up front.
+    static const int WORSENED_INFECTED_COUNT = 30;
+
+    //Smallest board the landscape fits on. The research facility's walls reach down to row 6, and its left wall
+    //(numCols-15) must stand to the right of the city wall (numCols/2+9), or the city wall runs through the facility.
+    static const int MIN_ROWS = 7;
+    static const int MIN_COLS = 49;
+
+    //Space below and beside the board used by printStatistics().
+    static const int STATISTICS_ROWS = 7;
+    static const int STATISTICS_COLS = 80;
+
+    //Flag set in "occupancy" for cells whose landscape cannot be walked on.
+    static const unsigned short CELL_BLOCKED = 0x8000;
+
+    //Values of "firstIngredientCarrier" and "secondIngredientCarrier" when no scavenger is carrying the ingredient.
+    static const int INGREDIENT_ON_MAP = -1;
+    static const int INGREDIENT_DELIVERED = -2;
 
 
     protected:
     //-------------Functions------------------
 
+    //Pieces of run(): place everything, advance one time unit, and draw it.
+    virtual void setUp();
+    virtual void tick();
+    void drawFrame();
+
+    //The end-of-game part of tick(): cure everyone or worsen the infection when the time comes, and set "timeToStopAt".
+    void advanceEndGame();
+
+    //Settle the outcome as soon as nothing left in the run can change it. Looks only at a few counters, so it runs every time unit.
+    void updateDecision();
+
+    //The two movement rules used by tick(): one human after another, or all at once in two phases.
+    void moveInTurn();
+    void moveAtOnce();
+
+    //Copy the state into "pendingCheckpoint" and write it to "checkpointPath" on "checkpointWriter".
+    void saveCheckpointInBackground();
+
+    //Wait until the checkpoint being written, if any, is on disk.
+    void finishCheckpoint();
+
+    //Body of the render thread: shows the newest published frame at a fixed rate until the simulation is done.
+    void renderLoop();
+
+    //Size the screen and start the render thread, and let it show the final frame and stop. Not for headless boards.
+    void startRendering();
+    void stopRendering();
+
+    //Apply the events of the next time unit of a trace, or one event.
+    bool playTraceTimeUnit(TraceReader& reader);
+    void applyTraceEvent(const TraceEvent& event);
+
     //Go through and process infection status
     void processInfection();  
 
+    //The two infection rules used by processInfection(): one adjacent pair after another, or everyone at once on bitboards.
+    void infectInTurn();
+    void infectAtOnce();
+
+    //Apply the infection rules to one pair of adjacent humans
+    void processContact(int i, int j);
+
+    //Take 1/4 of a scavenger's health, turning it into an infected human if it dies.
+    //A dead scavenger's ingredients go back where they were found.
+    void hurtScavenger(int id);
+
     //Tells whether all humans are infected
-    bool allInfected();       
+    virtual bool allInfected();       
 
     //Tells whether one human is next to another
-    bool isNextTo(Human* h1, Human* h2); 
+    bool isNextTo(int first, int second); 
 
 
     //Making the logical boards. Initializing the logical "landscapeBoard".
@@ -78,13 +255,40 @@ class Board {
     void markResearchFacility();
 
 
+        //Sets a landscape marker and updates that cell's passability in "occupancy".
+    void setLandscape(int row, int col, char marker);
+
+        //Position of a cell in the row-major "landscapeBoard" and "occupancy" arrays.
+    int cellIndex(int row, int col) { return row*numCols + col; }
+
+
     //Drawing the logical board onto the screen.
     void drawLandscape();
 
+    //Drawing every human onto the screen.
+    void drawHumans();
+
     //Placing humans in and outside the city walls.
     void populateCity();
     void populateOutsideOfCity();
 
+    //Adding agents, moving them, and changing their roles. Keeps "agents", "scavengers", and "occupancy" in sync.
+    int addAgent(int row, int col, bool infected, AgentRole role);
+    void moveAgent(int id, int row, int col);
+    void changeRole(int id, AgentRole role);
+
+    //Position of scavenger "id" in "scavengers", or of the first scavenger after it if "id" is not one.
+    size_t scavengerIndex(int id);
+
+    //Build the distance fields that scavengers walk by, if there are none yet.
+    void buildGoalFields();
+
+    //Bring the goal distance fields up to date with the cells whose passability changed since the last call.
+    void updateGoalFields();
+
+    //Copy every goal distance field from "fieldCache" and repair it for the ingredients still on the map.
+    void fetchGoalFields();
+
     //Remove the city wall.
     void destroyCity();
     
@@ -96,14 +300,23 @@ class Board {
     bool isWithinCity(int row, int col);
     bool isWithinResearchFacility(int row, int col);
 
-    //Randomly select a human within the city to become the scavenger.
+    //Randomly select "numScavengers" humans within the city to become scavengers.
     void selectScavenger();
 
-    //Check if scavenger has reached any goal points. If so, control scavenger's progress booleans.
+    //Check if each scavenger has reached any goal points. If so, control its progress booleans and the ingredients.
     void checkOnScavenger();
 
-    //Determine if scavenger is within 1 space of a goal point.
-    bool isNextToAGoal(int goalRow, int goalCol);
+    //Determine if a scavenger is within 1 space of a goal point.
+    bool isNextToAGoal(int id, int goalRow, int goalCol);
+
+    //Mark the ingredients a scavenger carries as delivered.
+    void deliverIngredients(int id);
+
+    //Put an ingredient back on the map when the scavenger carrying it dies, on a cell nobody stands on.
+    void dropIngredient(char marker, int id);
+
+    //Mark an ingredient on the map at (row, col), and point its goal field there.
+    void placeIngredient(char marker, int row, int col);
 
     //Update statistic percentages of vaccine research and city wall health.
     void updateResearchProgress();
@@ -116,19 +329,50 @@ class Board {
     //End-of-the-game functions:
 
         //Vaccine research reached 100%, now cure all infected.
-    void applyVaccine();
+    virtual void applyVaccine();
         //Scavenger died and vaccine is hopeless, create more infected and change doctors into regular humans.
-    void makeInfectionWorse();
+    virtual void makeInfectionWorse();
 
 
 
     //-------------Variables------------------
 
     //The main logical board that keeps track of the city wall, research facility, and ingredients.
-    char landscapeBoard[MAX_NUM_ROWS][MAX_NUM_COLS];
+    //Stored row-major in one numRows x numCols allocation; index it with cellIndex(row, col).
+    vector<char> landscapeBoard;
+
+    //Every agent's row, column, infection status, role, and scavenger progress, indexed by agent id.
+    AgentStore agents;
+
+    //Occupancy index answering tryMove() with a single lookup, laid out like "landscapeBoard".
+    //The low bits count the humans standing on a cell, and CELL_BLOCKED is set
+    //when the landscape there is anything other than EMPTY or RESEARCH_FLOOR.
+    vector<unsigned short> occupancy;
+
+    //Spatial buckets used by processInfection() to find adjacent humans.
+    NeighborGrid neighborGrid;
+
+    //Reused buffer for the results of neighborGrid queries.
+    vector<int> neighbors;
+
+    //Where the infected, healthy humans, and doctors stand, used by infectAtOnce().
+    InfectionBitboard infectionBitboard;
+
+    //Whether processInfection() uses infectAtOnce().
+    bool bitboardInfection;
+
+    //Distance to each scavenger goal point, indexed by ScavengerGoal. Built by buildGoalFields() and kept up to date by updateGoalFields().
+    vector<DistanceField> goalFields;
+    bool goalFieldsReady;
 
-    //The main logical board that keeps track of human objects.
-    Human* humans[MAX_HUMAN_COUNT];
+    //Where the goal distance fields come from, if they are shared with other boards. NULL to build them here.
+    FieldCache* fieldCache;
+
+    //Cells that setLandscape() turned from walkable to blocked or back since the goal fields were last updated.
+    vector<int> changedCells;
+
+    //Number of times setLandscape() has turned a cell from walkable to blocked or back, so other views of the walls can tell when to catch up.
+    int passabilityChanges;
 
     //Initial variables to create board and run the simulation.
     int numHumans;            // Num humans
@@ -137,7 +381,50 @@ class Board {
     int currentTime;          // Current time in simulation
     int numRows;              // Number of rows in board
     int numCols;              // Number of cols in board
-    int uSleepTime;           // Num microseconds to sleep between updates
+    int uSleepTime;           // Num microseconds to sleep between updates (0 for no throttling)
+    int frameInterval;        // Num microseconds between frames shown by the render thread
+    int tickLimit;            // Last time unit to simulate
+    int timeToStopAt;         // Time unit to stop at once the game has ended, or -1
+
+    //Whether the outcome can no longer change, why, and at which time unit that became so. Headless runs stop right there.
+    bool outcomeDecided;
+    OutcomeReason decidedReason;
+    int decidedTime;
+
+    //Whether to skip drawing and sleeping.
+    bool headless;
+
+    //Whether the state came from restoreCheckpoint() instead of setUp().
+    bool restored;
+
+    //Where and how often (in time units) run() writes checkpoints. 0 for never.
+    string checkpointPath;
+    int checkpointInterval;
+
+    //Copy of the state being written by "checkpointWriter", so the tick loop can go on meanwhile.
+    Checkpoint pendingCheckpoint;
+    thread checkpointWriter;
+
+    //Where run() records the run, if anywhere, how often it writes keyframes, and the trace being recorded.
+    string tracePath;
+    int traceKeyframeInterval;
+    Trace trace;
+
+    //Reused copy of the state for trace keyframes, both when recording and when seeking.
+    Checkpoint traceKeyframe;
+
+    //Threads used by moveAtOnce(), or 0 to use moveInTurn().
+    int moveThreads;
+
+    //Pool that runs the phases of moveAtOnce().
+    WorkerPool movePool;
+
+    //Cell index each human is trying to move to this time unit (-1 to stay), used by moveAtOnce().
+    vector<int> moveTarget;
+
+    //Lowest priority value of the humans trying to move to each cell, or UNCLAIMED. Only allocated for moveAtOnce().
+    vector<atomic<uint32_t> > claims;
+    static const uint32_t UNCLAIMED = 0xFFFFFFFF;
 
     //Boolean to keep track of if the city wall should be removed or not.
     bool cityIsDestroyed;
@@ -156,11 +443,19 @@ class Board {
     int researchFacilityRow;
     int researchFacilityCol;
 
-    //Index for scavenger in "humans" logical board.
-    int scavengerPos;
+    //Number of scavengers selectScavenger() sends out, and how many it did send (fewer if not enough humans qualified).
+    int numScavengers;
+    int numScavengersSent;
+
+    //The living scavengers, in ascending order of agent id. Kept in step with the roles by changeRole() and addAgent().
+    //Each scavenger's progress and health are in "agents".
+    vector<Scavenger> scavengers;
 
-    //Numerical values for scavenger and city wall "health".
-    int scavengerHealth;
+    //Agent id of the scavenger carrying each ingredient, or INGREDIENT_ON_MAP or INGREDIENT_DELIVERED.
+    int firstIngredientCarrier;
+    int secondIngredientCarrier;
+
+    //Numerical value for city wall "health".
     int cityWallHealth;
 
     //Numerical value for vaccine research progress.
@@ -169,18 +464,33 @@ class Board {
     //Game note to be displayed based on currentTime and game status.
     string gameNote;
 
+    //Frame that drawFrame() draws into on the simulation thread. Only sized when the board is not headless.
+    Screen screen;
+
+    //Finished frames on their way from the simulation thread to the render thread.
+    FrameExchange frames;
+
+    //Double-buffered terminal that the render thread presents published frames on.
+    Screen display;
+
+    //Set by the simulation thread once the last frame has been published.
+    atomic<bool> simulationDone;
+
+    //Thread running renderLoop().
+    thread renderer;
+
     //End-of-the-game booleans:
         //Keeps track of if the vaccine reached 100% and was applied.
     bool vaccineApplied;
         //Keeps track of if more infected were released to kill off the remaining humans.
     bool infectionWorsened;
 
-    //Booleans to keep track of if the scavenger has reached the 1st or 2nd ingredient. 
-    bool firstIngredientAttained;
-    bool secondIngredientAttained;
-	
 	private:
-	int random();
+    //Generator behind random(). Owned by this board alone.
+    Random generator;
+
+    //Seed last given to setSeed(), 0 if none. Carried through checkpoints so a restored run still knows it.
+    uint64_t startingSeed;
 };
 
 #endif //#ifndef BOARD_H
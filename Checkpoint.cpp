@@ -0,0 +1,269 @@
+/**
+ * @file Checkpoint.cpp
+ * @brief The Checkpoint struct implementation file.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include "Board.h"
+#include "Checkpoint.h"
+#include "Varint.h"
+
+using namespace std;
+
+//First bytes of every checkpoint file.
+static const char MAGIC[4] = {'I', 'S', 'C', 'K'};
+
+//Layout of the flags byte written for each agent.
+static const int INFECTED_BIT = 1;
+static const int ROLE_SHIFT = 1;
+static const int ROLE_MASK = 3;
+static const int PROGRESS_SHIFT = 3;
+
+//Every ScavengerProgress bit, and every health a live scavenger can have: full, less 25 for each hurt, and above 0.
+static const int ALL_PROGRESS = REACHED_GATE | HAS_FIRST_INGREDIENT | HAS_SECOND_INGREDIENT | REACHED_RESEARCH_FACILITY;
+static const int FULL_HEALTH = 100;
+static const int HURT_DAMAGE = 25;
+
+
+/**
+ * @brief Reads a signed variable-length number into an int.
+ * @param[in] in The binary stream to read from.
+ * @param[out] value Where to put the number.
+ * @return false if the stream ended or failed.
+ */
+static bool readInt(istream& in, int& value) {
+    int64_t wide;
+    if (! varint::readSigned(in, wide)) return false;
+    value = int(wide);
+    return true;
+}
+
+
+/**
+ * @brief Tells whether a location is on a board.
+ * @param[in] row The row.
+ * @param[in] col The column.
+ * @param[in] numRows The number of rows in the board.
+ * @param[in] numCols The number of columns in the board.
+ * @return Whether (row, col) is on the board.
+ */
+static bool isOnBoard(int row, int col, int numRows, int numCols) {
+    return row >= 0 && row < numRows && col >= 0 && col < numCols;
+}
+
+
+/**
+ * @brief Tells whether an ingredient carrier read from a file is possible: no one, or one of the scavengers.
+ * @param[in] carrier The carrier's agent id, Board::INGREDIENT_ON_MAP, or Board::INGREDIENT_DELIVERED.
+ * @param[in] agents The agents read from the file.
+ * @return Whether the carrier is possible.
+ */
+static bool isValidCarrier(int carrier, const AgentStore& agents) {
+    if (carrier == Board::INGREDIENT_ON_MAP || carrier == Board::INGREDIENT_DELIVERED) return true;
+    return carrier >= 0 && size_t(carrier) < agents.row.size() && agents.role[carrier] == ROLE_SCAVENGER;
+}
+
+
+/**
+ * @brief Reads a variable-length number into a bool.
+ * @param[in] in The binary stream to read from.
+ * @param[out] value Where to put the value.
+ * @return false if the stream ended or failed.
+ */
+static bool readBool(istream& in, bool& value) {
+    uint64_t number;
+    if (! varint::read(in, number)) return false;
+    value = (number != 0);
+    return true;
+}
+
+
+/**
+ * @brief Writes the checkpoint in the binary format.
+ * @param[in] out The binary stream to write to.
+ */
+void Checkpoint::write(ostream& out) const {
+    out.write(MAGIC, sizeof(MAGIC));
+    varint::write(out, VERSION);
+
+    varint::writeSigned(out, numRows);
+    varint::writeSigned(out, numCols);
+    varint::writeSigned(out, numHumans);
+    varint::writeSigned(out, numDoctors);
+    varint::writeSigned(out, numInfected);
+
+    varint::writeSigned(out, currentTime);
+    varint::writeSigned(out, tickLimit);
+    varint::writeSigned(out, timeToStopAt);
+
+    varint::write(out, movesAtOnce);
+    varint::write(out, bitboardInfection);
+
+    varint::write(out, cityIsDestroyed);
+    varint::writeSigned(out, cityStartingColumn);
+    varint::writeSigned(out, cityEndingRow);
+    varint::writeSigned(out, researchFacilityEndingRow);
+    varint::writeSigned(out, researchFacilityStartingCol);
+    varint::writeSigned(out, firstIngredientRow);
+    varint::writeSigned(out, firstIngredientCol);
+    varint::writeSigned(out, secondIngredientRow);
+    varint::writeSigned(out, secondIngredientCol);
+    varint::writeSigned(out, gateRow);
+    varint::writeSigned(out, gateCol);
+    varint::writeSigned(out, researchFacilityRow);
+    varint::writeSigned(out, researchFacilityCol);
+
+    varint::writeSigned(out, numScavengers);
+    varint::writeSigned(out, numScavengersSent);
+    varint::writeSigned(out, firstIngredientCarrier);
+    varint::writeSigned(out, secondIngredientCarrier);
+    varint::writeSigned(out, cityWallHealth);
+    uint32_t progressBits;
+    memcpy(&progressBits, &vaccineResearchProgress, sizeof(progressBits));
+    varint::write(out, progressBits);
+    varint::write(out, vaccineApplied);
+    varint::write(out, infectionWorsened);
+
+    generator.save(out);
+    varint::write(out, seed);
+
+    //Landscape, as runs of the same marker. Most of the board is one long run of empty cells.
+    size_t cell = 0;
+    while (cell < landscape.size()) {
+        size_t runEnd = cell + 1;
+        while (runEnd < landscape.size() && landscape[runEnd] == landscape[cell]) {
+            runEnd++;
+        }
+        out.put(landscape[cell]);
+        varint::write(out, runEnd - cell);
+        cell = runEnd;
+    }
+
+    //Agents. Role and scavenger progress share one byte with the infection status. Only scavengers have a health.
+    varint::write(out, agents.row.size());
+    for (size_t id=0; id<agents.row.size(); id++) {
+        varint::write(out, agents.row[id]);
+        varint::write(out, agents.col[id]);
+        out.put(char((agents.infected[id] ? INFECTED_BIT : 0) | (agents.role[id] << ROLE_SHIFT) | (agents.progress[id] << PROGRESS_SHIFT)));
+        if (agents.role[id] == ROLE_SCAVENGER) {
+            out.put(char(agents.health[id]));
+        }
+    }
+}
+
+
+/**
+ * @brief Reads a checkpoint written by write().
+ * @param[in] in The binary stream to read from.
+ * @return false if the stream does not hold a checkpoint of this version, holds an impossible one, or ends early.
+ *         The checkpoint's contents are then unspecified.
+ */
+bool Checkpoint::read(istream& in) {
+    char magic[sizeof(MAGIC)];
+    if (! in.read(magic, sizeof(magic)) || memcmp(magic, MAGIC, sizeof(MAGIC)) != 0) return false;
+
+    uint64_t version;
+    if (! varint::read(in, version) || version != VERSION) return false;
+
+    bool ok = readInt(in, numRows) && readInt(in, numCols) && readInt(in, numHumans) && readInt(in, numDoctors) && readInt(in, numInfected)
+        && readInt(in, currentTime) && readInt(in, tickLimit) && readInt(in, timeToStopAt)
+        && readBool(in, movesAtOnce) && readBool(in, bitboardInfection)
+        && readBool(in, cityIsDestroyed) && readInt(in, cityStartingColumn) && readInt(in, cityEndingRow)
+        && readInt(in, researchFacilityEndingRow) && readInt(in, researchFacilityStartingCol)
+        && readInt(in, firstIngredientRow) && readInt(in, firstIngredientCol) && readInt(in, secondIngredientRow) && readInt(in, secondIngredientCol)
+        && readInt(in, gateRow) && readInt(in, gateCol) && readInt(in, researchFacilityRow) && readInt(in, researchFacilityCol)
+        && readInt(in, numScavengers) && readInt(in, numScavengersSent) && readInt(in, firstIngredientCarrier) && readInt(in, secondIngredientCarrier)
+        && readInt(in, cityWallHealth);
+    if (! ok || numRows < Board::MIN_ROWS || numCols < Board::MIN_COLS || numHumans < 0) return false;
+
+    //The structures and goal points are drawn and walked to, so they must be on the board.
+    ok = isOnBoard(cityEndingRow, cityStartingColumn, numRows, numCols)
+        && isOnBoard(researchFacilityEndingRow, researchFacilityStartingCol, numRows, numCols)
+        && isOnBoard(firstIngredientRow, firstIngredientCol, numRows, numCols) && isOnBoard(secondIngredientRow, secondIngredientCol, numRows, numCols)
+        && isOnBoard(gateRow, gateCol, numRows, numCols) && isOnBoard(researchFacilityRow, researchFacilityCol, numRows, numCols);
+    if (! ok) return false;
+
+    uint64_t progressBits;
+    if (! varint::read(in, progressBits)) return false;
+    uint32_t narrowBits = uint32_t(progressBits);
+    memcpy(&vaccineResearchProgress, &narrowBits, sizeof(narrowBits));
+
+    ok = readBool(in, vaccineApplied) && readBool(in, infectionWorsened);
+    if (! ok) return false;
+
+    generator.load(in);
+    if (! in || ! varint::read(in, seed)) return false;
+
+    //Landscape runs, which must exactly cover the board.
+    size_t numCells = size_t(numRows)*numCols;
+    landscape.clear();
+    landscape.reserve(numCells);
+    while (landscape.size() < numCells) {
+        int marker = in.get();
+        uint64_t runLength;
+        if (marker == EOF || ! varint::read(in, runLength) || runLength > numCells-landscape.size()) return false;
+        landscape.insert(landscape.end(), runLength, char(marker));
+    }
+
+    //Agents, which must all be on the board, with a real role, and if they are scavengers, a progress and health they could have got to.
+    uint64_t numAgents;
+    if (! varint::read(in, numAgents) || numAgents != uint64_t(numHumans)) return false;
+
+    agents = AgentStore();
+    agents.reserve(numAgents);
+    for (uint64_t id=0; id<numAgents; id++) {
+        uint64_t row, col;
+        if (! varint::read(in, row) || ! varint::read(in, col)) return false;
+        int flags = in.get();
+        if (flags == EOF || row >= uint64_t(numRows) || col >= uint64_t(numCols)) return false;
+
+        int role = (flags >> ROLE_SHIFT) & ROLE_MASK;
+        int progress = flags >> PROGRESS_SHIFT;
+        if (role > ROLE_SCAVENGER || (progress & ~ALL_PROGRESS) != 0 || (role != ROLE_SCAVENGER && progress != 0)) return false;
+
+        agents.add(int(row), int(col), flags & INFECTED_BIT, AgentRole(role));
+        agents.progress[id] = (unsigned char)progress;
+        if (agents.role[id] == ROLE_SCAVENGER) {
+            int health = in.get();
+            if (health == EOF || health <= 0 || health > FULL_HEALTH || health % HURT_DAMAGE != 0) return false;
+            agents.health[id] = (unsigned char)health;
+        }
+    }
+
+    //Ingredients can only be carried by scavengers.
+    return isValidCarrier(firstIngredientCarrier, agents) && isValidCarrier(secondIngredientCarrier, agents);
+}
+
+
+/**
+ * @brief Writes the checkpoint to a file.
+ * The checkpoint is written to "path.tmp" and then renamed, so a crash never leaves a half-written file under "path".
+ * @param[in] path The file to write.
+ * @return false if the file could not be written.
+ */
+bool Checkpoint::save(const string& path) const {
+    string tempPath = path + ".tmp";
+    {
+        ofstream out(tempPath.c_str(), ios::binary | ios::trunc);
+        if (! out) return false;
+        write(out);
+        out.flush();
+        if (! out) return false;
+    }
+    return rename(tempPath.c_str(), path.c_str()) == 0;
+}
+
+
+/**
+ * @brief Reads a checkpoint from a file.
+ * @param[in] path The file to read.
+ * @return false if the file could not be opened or is not a valid checkpoint (see read()).
+ */
+bool Checkpoint::load(const string& path) {
+    ifstream in(path.c_str(), ios::binary);
+    if (! in) return false;
+    return read(in);
+}
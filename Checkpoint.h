@@ -0,0 +1,90 @@
+/**
+ * @file Checkpoint.h
+ * @brief The Checkpoint struct declaration file.
+ */
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stdint.h>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "AgentStore.h"
+#include "Random.h"
+
+using namespace std;
+
+/**
+ * @brief A copy of everything a Board needs to continue a run exactly where it left off.
+ * Filled by Board::captureCheckpoint() and applied by Board::restoreCheckpoint().
+ * write() and read() convert it to and from a compact, versioned binary format:
+ * a magic number and version, then the numbers below as variable-length integers, the landscape run-length encoded,
+ * and each agent as its row, column, and one byte of flags, followed by its health if it is a scavenger.
+ */
+struct Checkpoint {
+    //Bumped whenever the format changes. Files with another version are refused.
+    static const uint32_t VERSION = 1;
+
+    //Scenario.
+    int numRows;
+    int numCols;
+    int numHumans;
+    int numDoctors;
+    int numInfected;
+
+    //Timers. "currentTime" is the last time unit that was completed.
+    int currentTime;
+    int tickLimit;
+    int timeToStopAt;
+
+    //Rules the run is played by. Whether humans move all at once (Board::setMoveThreads() with any number of threads) or one after another,
+    //and whether they are infected on bitboards (Board::setBitboardInfection()) or one adjacent pair after another.
+    bool movesAtOnce;
+    bool bitboardInfection;
+
+    //Landscape and the coordinates of its structures and goal points.
+    vector<char> landscape;
+    bool cityIsDestroyed;
+    int cityStartingColumn;
+    int cityEndingRow;
+    int researchFacilityEndingRow;
+    int researchFacilityStartingCol;
+    int firstIngredientRow;
+    int firstIngredientCol;
+    int secondIngredientRow;
+    int secondIngredientCol;
+    int gateRow;
+    int gateCol;
+    int researchFacilityRow;
+    int researchFacilityCol;
+
+    //Scavengers, ingredients, and progress.
+    int numScavengers;
+    int numScavengersSent;
+    int firstIngredientCarrier;
+    int secondIngredientCarrier;
+    int cityWallHealth;
+    float vaccineResearchProgress;
+    bool vaccineApplied;
+    bool infectionWorsened;
+
+    //Every agent, with its role, and its progress and health if it is a scavenger.
+    AgentStore agents;
+
+    //The board's random number generator, and the seed the run started from. Only the generator matters to the game;
+    //the seed is kept so a restored run can report it.
+    Random generator;
+    uint64_t seed;
+
+    //Convert to and from the binary format. read() returns false for a file that is not a checkpoint of this version, or is cut short.
+    void write(ostream& out) const;
+    bool read(istream& in);
+
+    //Same, for a file. save() writes a temporary file first, so an existing checkpoint is only replaced by a complete one.
+    bool save(const string& path) const;
+    bool load(const string& path);
+};
+
+#endif // CHECKPOINT_H
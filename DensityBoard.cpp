@@ -0,0 +1,313 @@
+/**
+ * @file DensityBoard.cpp
+ * @brief The DensityBoard class implementation file.
+ */
+
+#include <algorithm>
+
+#include "DensityBoard.h"
+
+using namespace std;
+
+const float DensityBoard::DIFFUSION_RATE = 0.5f;
+const float DensityBoard::INFECTION_RATE = 0.5f;
+const float DensityBoard::HEAL_RATE = 0.5f;
+
+//Fewest people a cell can hold without being counted as empty.
+static const float NEGLIGIBLE = 1e-12f;
+
+
+/**
+ * @brief The DensityBoard class constructor.
+ * The board holds no agents, so the Board is built for none and only told the population afterwards.
+ *
+ * @param rows The number of rows to make the board.
+ * @param cols The number of columns to make the board.
+ * @param numberOfHumans The number of people to spread over the board.
+ * @param numberOfDoctors How many of them are doctors.
+ */
+DensityBoard::DensityBoard(int rows, int cols, int numberOfHumans, int numberOfDoctors) : Board(rows, cols, 0, 0) {
+    numHumans = numberOfHumans;
+    numDoctors = numberOfDoctors;
+    headless = true;
+
+    planeCols = numCols+2;
+    int planeSize = (numRows+2)*planeCols;
+    susceptible.assign(planeSize, 0);
+    infected.assign(planeSize, 0);
+    doctors.assign(planeSize, 0);
+    nextSusceptible.assign(planeSize, 0);
+    nextInfected.assign(planeSize, 0);
+    nextDoctors.assign(planeSize, 0);
+    open.assign(planeSize, 0);
+    openNeighbors.assign(planeSize, 0);
+    openCellsVersion = -1;
+
+    columnSusceptible.assign(planeCols, 0);
+    columnInfected.assign(planeCols, 0);
+    totalSusceptible = 0;
+    totalInfected = 0;
+}
+
+
+/**
+ * @brief Sum of the 3x3 block of a padded plane centered on "cell".
+ * @param[in] plane The plane.
+ * @param[in] cell The index of the center cell.
+ * @param[in] stride Cells per row of the plane.
+ * @return The sum.
+ */
+static inline float blockSum(const float* plane, int cell, int stride) {
+    return plane[cell-stride-1] + plane[cell-stride] + plane[cell-stride+1]
+         + plane[cell-1]        + plane[cell]        + plane[cell+1]
+         + plane[cell+stride-1] + plane[cell+stride] + plane[cell+stride+1];
+}
+
+
+/**
+ * @brief The smaller of a value and its cap, written so that it compiles to a vector min instruction.
+ * @param[in] value The value.
+ * @param[in] cap The cap.
+ * @return The capped value.
+ */
+static inline float capped(float value, float cap) {
+    return (value < cap) ? value : cap;
+}
+
+
+/**
+ * @brief Updates one row of cells by a time unit. The heart of DensityBoard::spread().
+ * Every cell is handled the same way, with no branches, and the output planes never overlap the input ones,
+ * so the compiler can work on several cells at once with vector instructions. Walls come in through "open"
+ * and "openNeighbors" alone: closed cells hold no one, receive no one, and people never step into them.
+ * All pointers point at the first board cell of the row, in the padded planes. Kept out of line, because GCC stops vectorizing the loop once it is inlined into spread().
+ * @param[in] width Cells in the row.
+ * @param[in] stride Cells per row of the planes.
+ * @param[in] susceptible, infected, doctors The people on each cell.
+ * @param[in] open, openNeighbors Whether each cell is open, and how many of its neighbors are.
+ * @param[out] nextSusceptible, nextInfected, nextDoctors The people on each cell one time unit later.
+ * @param[in,out] columnSusceptible, columnInfected Running totals of the new planes, per column.
+ */
+static __attribute__((noinline)) void spreadRow(int width, int stride,
+                      const float* __restrict__ susceptible, const float* __restrict__ infected, const float* __restrict__ doctors,
+                      const float* __restrict__ open, const float* __restrict__ openNeighbors,
+                      float* __restrict__ nextSusceptible, float* __restrict__ nextInfected, float* __restrict__ nextDoctors,
+                      float* __restrict__ columnSusceptible, float* __restrict__ columnInfected) {
+    const float step = DensityBoard::DIFFUSION_RATE/8;
+    const float maxChance = 1-DensityBoard::DIFFUSION_RATE;
+
+    for (int c=0; c<width; c++) {
+        float susceptibleHere = susceptible[c];
+        float infectedHere = infected[c];
+        float doctorsHere = doctors[c];
+        float infectedBlock = blockSum(infected, c, stride);
+        float doctorsBlock = blockSum(doctors, c, stride);
+
+        //People stepping toward open neighbors leave; the rest stay.
+        float stay = 1 - step*openNeighbors[c];
+
+        //Infections and heals come from everyone in the 3x3 block, as Board::isNextTo() counts adjacency.
+        float infectChance = capped(DensityBoard::INFECTION_RATE*infectedBlock, maxChance);
+        float healChance = capped(DensityBoard::HEAL_RATE*doctorsBlock, maxChance);
+        float infections = infectChance*susceptibleHere;
+        float heals = healChance*infectedHere;
+
+        float newSusceptible = open[c] * (susceptibleHere*stay + step*(blockSum(susceptible, c, stride)-susceptibleHere) - infections + heals);
+        float newInfected = open[c] * (infectedHere*stay + step*(infectedBlock-infectedHere) + infections - heals);
+        float newDoctors = open[c] * (doctorsHere*stay + step*(doctorsBlock-doctorsHere));
+
+        //Drop the last traces of people who have all but left, before they decay into slow denormal floats.
+        newSusceptible = (newSusceptible < NEGLIGIBLE) ? 0.0f : newSusceptible;
+        newInfected = (newInfected < NEGLIGIBLE) ? 0.0f : newInfected;
+        newDoctors = (newDoctors < NEGLIGIBLE) ? 0.0f : newDoctors;
+
+        nextSusceptible[c] = newSusceptible;
+        nextInfected[c] = newInfected;
+        nextDoctors[c] = newDoctors;
+        columnSusceptible[c] += newSusceptible;
+        columnInfected[c] += newInfected;
+    }
+}
+
+
+/**
+ * @brief Builds the landscape and spreads the people over it.
+ * Mirrors Board::setUp(): a third of the people (the doctors among them) live in the city, spread evenly over its open cells,
+ * and the rest outside the city wall, about half of them infected.
+ */
+void DensityBoard::setUp() {
+    makeLandscape();
+    markResearchFacility();
+    updateOpenCells();
+
+    int inCity = int(numHumans/3);
+    int outside = numHumans - inCity;
+    int infectedOutside = min(outside, numHumans - 2*inCity + 1);
+
+    fillColumns(doctors, numDoctors, cityStartingColumn+2, numCols-1);
+    fillColumns(susceptible, inCity - numDoctors, cityStartingColumn+2, numCols-1);
+    fillColumns(infected, infectedOutside, 0, cityStartingColumn-3);
+    fillColumns(susceptible, outside - infectedOutside, 0, cityStartingColumn-3);
+
+    totalSusceptible = numHumans - numDoctors - infectedOutside;
+    totalInfected = infectedOutside;
+    numInfected = infectedOutside;
+
+    timeToStopAt = -1;
+}
+
+
+/**
+ * @brief Advances the simulation by one time unit.
+ * Everyone spreads, and is infected and healed, at once; then the research, the city wall, the gate, and the end of the game
+ * move on exactly as in Board::tick(). No scavengers are sent out.
+ */
+void DensityBoard::tick() {
+    updateOpenCells();
+    spread();
+
+    updateResearchProgress();
+    updateCityWallHealth();
+    makeResearchFacility();
+
+    if (currentTime == 30) {
+        openCityGate();
+    }
+
+    advanceEndGame();
+}
+
+
+/**
+ * @brief Runs spreadRow() over every row of the board into the "next" planes, then swaps them in and totals them.
+ */
+void DensityBoard::spread() {
+    fill(columnSusceptible.begin(), columnSusceptible.end(), 0.0f);
+    fill(columnInfected.begin(), columnInfected.end(), 0.0f);
+
+    for (int row=0; row<numRows; row++) {
+        int first = planeIndex(row, 0);
+        spreadRow(numCols, planeCols,
+                  &susceptible[first], &infected[first], &doctors[first],
+                  &open[first], &openNeighbors[first],
+                  &nextSusceptible[first], &nextInfected[first], &nextDoctors[first],
+                  &columnSusceptible[1], &columnInfected[1]);
+    }
+
+    susceptible.swap(nextSusceptible);
+    infected.swap(nextInfected);
+    doctors.swap(nextDoctors);
+
+    totalSusceptible = 0;
+    totalInfected = 0;
+    for (int col=0; col<planeCols; col++) {
+        totalSusceptible += columnSusceptible[col];
+        totalInfected += columnInfected[col];
+    }
+    numInfected = int(totalInfected + 0.5);
+}
+
+
+/**
+ * @brief Rebuilds which cells are open, and how many open neighbors each has, once the walls have changed.
+ * Anyone left standing on a cell that has just been closed is lost at the next spread(); only the gate closing can do that.
+ */
+void DensityBoard::updateOpenCells() {
+    if (openCellsVersion == passabilityChanges) return;
+    openCellsVersion = passabilityChanges;
+
+    for (int row=0; row<numRows; row++) {
+        for (int col=0; col<numCols; col++) {
+            open[planeIndex(row, col)] = (occupancy[cellIndex(row, col)] & CELL_BLOCKED) ? 0.0f : 1.0f;
+        }
+    }
+    for (int row=0; row<numRows; row++) {
+        for (int col=0; col<numCols; col++) {
+            int cell = planeIndex(row, col);
+            openNeighbors[cell] = blockSum(&open[0], cell, planeCols) - open[cell];
+        }
+    }
+}
+
+
+/**
+ * @brief Spreads people evenly over the open cells of a range of columns, on every row.
+ * @param[in,out] plane The plane to add them to.
+ * @param[in] count How many people to add.
+ * @param[in] firstCol The first column of the range.
+ * @param[in] lastCol The last column of the range.
+ */
+void DensityBoard::fillColumns(vector<float>& plane, float count, int firstCol, int lastCol) {
+    int openCells = 0;
+    for (int row=0; row<numRows; row++) {
+        for (int col=firstCol; col<=lastCol; col++) {
+            openCells += int(open[planeIndex(row, col)]);
+        }
+    }
+    if (openCells == 0) return;
+
+    float perCell = count / openCells;
+    for (int row=0; row<numRows; row++) {
+        for (int col=firstCol; col<=lastCol; col++) {
+            plane[planeIndex(row, col)] += perCell * open[planeIndex(row, col)];
+        }
+    }
+}
+
+
+/**
+ * @brief Cures everyone: every cell's infected become susceptible again.
+ */
+void DensityBoard::applyVaccine() {
+    if (! vaccineApplied) {
+        for (size_t cell=0; cell<infected.size(); cell++) {
+            susceptible[cell] += infected[cell];
+            infected[cell] = 0;
+        }
+        totalSusceptible += totalInfected;
+        totalInfected = 0;
+        numInfected = 0;
+        vaccineApplied = true;
+    }
+}
+
+
+/**
+ * @brief Turns every doctor into a susceptible person, and drops WORSENED_INFECTED_COUNT infected people on random open cells.
+ */
+void DensityBoard::makeInfectionWorse() {
+    if (! infectionWorsened) {
+        int row, col;
+
+        //Remove doctors.
+        for (size_t cell=0; cell<doctors.size(); cell++) {
+            susceptible[cell] += doctors[cell];
+            totalSusceptible += doctors[cell];
+            doctors[cell] = 0;
+        }
+
+        //Place more infected.
+        for (int pos=0; pos<WORSENED_INFECTED_COUNT; pos++) {
+            do {
+                row = random() % numRows; //row will be in range(0, numRows-1)
+                col = random() % numCols; //col will be in range(0, numCols-1)
+            } while (open[planeIndex(row, col)] == 0);
+            infected[planeIndex(row, col)] += 1;
+        }
+
+        numHumans += WORSENED_INFECTED_COUNT;
+        totalInfected += WORSENED_INFECTED_COUNT;
+        numInfected = int(totalInfected + 0.5);
+
+        infectionWorsened = true;
+    }
+}
+
+
+/**
+ * @brief Tells whether fewer than half a susceptible person is left on the whole board.
+ * @return Whether everyone who can be infected is.
+ */
+bool DensityBoard::allInfected() {
+    return totalSusceptible < 0.5;
+}
@@ -0,0 +1,92 @@
+/**
+ * @file DensityBoard.h
+ * @brief The DensityBoard class declaration file.
+ */
+
+#ifndef DENSITYBOARD_H
+#define DENSITYBOARD_H
+
+#include <vector>
+
+#include "Board.h"
+
+using namespace std;
+
+/**
+ * @class DensityBoard
+ * @brief A Board that tracks how many susceptible, infected, and doctor people stand on each cell instead of individual humans.
+ * Every time unit, each cell's people spread to its neighbors, susceptible people are infected by the infected people around them,
+ * and infected people are healed by the doctors around them, all in one pass of a 3x3 stencil over the whole board.
+ * The landscape, the research and city wall progress, the gate, and the end of the game are the Board's own.
+ * Density boards are always headless, and have no scavengers, checkpoints, or traces.
+ */
+class DensityBoard : public Board {
+    public:
+    DensityBoard(int numRows, int numCols, int numHumans, int numDoctors);
+
+    //Fraction of a cell's people that step to the neighboring cells each time unit, split evenly between the 8 directions.
+    //People heading into a wall stay where they are.
+    static const float DIFFUSION_RATE;
+
+    //Chance a susceptible person is infected per infected person in the 3x3 block around them, and a
+    //chance an infected person is healed per doctor in the block. Both are capped at 1-DIFFUSION_RATE.
+    static const float INFECTION_RATE;
+    static const float HEAL_RATE;
+
+
+    protected:
+    //Build the landscape and spread the humans over it, in the same proportions Board::setUp() places them.
+    void setUp();
+
+    //Spread, infect, and heal everyone, then move the game on as Board::tick() does.
+    void tick();
+
+    //Update the people on every cell by one time unit.
+    void spread();
+
+    //Rebuild "open" and "openNeighbors" from the occupancy index if any wall has appeared or disappeared since they were built.
+    void updateOpenCells();
+
+    //Spread "count" people evenly over the open cells of columns [firstCol, lastCol] of "plane".
+    void fillColumns(vector<float>& plane, float count, int firstCol, int lastCol);
+
+    //Position of a board cell in the padded planes.
+    int planeIndex(int row, int col) { return (row+1)*planeCols + col+1; }
+
+    //End-of-the-game functions, on densities.
+    void applyVaccine();
+    void makeInfectionWorse();
+    bool allInfected();
+
+
+    //Columns in each padded plane: the board's columns and a column of closed cells on either side.
+    //There is also a row of closed cells above and below the board, so the stencil never needs bounds checks.
+    int planeCols;
+
+    //People on each cell, in padded row-major planes. Closed cells always hold 0.
+    vector<float> susceptible;
+    vector<float> infected;
+    vector<float> doctors;
+
+    //The planes being written by spread(), swapped in once it is done.
+    vector<float> nextSusceptible;
+    vector<float> nextInfected;
+    vector<float> nextDoctors;
+
+    //1 for cells people can stand on, 0 for walls, ingredients, and the padding.
+    vector<float> open;
+
+    //Number of open cells among each cell's 8 neighbors.
+    vector<float> openNeighbors;
+
+    //Value of Board::passabilityChanges when "open" was last built, or -1 before the first build.
+    int openCellsVersion;
+
+    //Totals of the planes as of the last spread(), per column of the padded planes and over the whole board.
+    vector<float> columnSusceptible;
+    vector<float> columnInfected;
+    double totalSusceptible;
+    double totalInfected;
+};
+
+#endif // DENSITYBOARD_H
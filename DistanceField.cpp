@@ -0,0 +1,179 @@
+/**
+ * @file DistanceField.cpp
+ * @brief The DistanceField class implementation file.
+ */
+
+#include <algorithm>
+
+#include "Board.h"
+#include "DistanceField.h"
+
+using namespace std;
+
+const int DistanceField::UNREACHABLE;
+
+/**
+ * @brief The DistanceField class constructor.
+ * Every cell starts out unreachable until build() is called.
+ *
+ * @param rows The number of rows in the board.
+ * @param cols The number of columns in the board.
+ */
+DistanceField::DistanceField(int rows, int cols) {
+    numRows = rows;
+    numCols = cols;
+    goalCell = -1;
+    distance.assign(numRows*numCols, UNREACHABLE);
+}
+
+
+/**
+ * @brief Computes the distance from every cell to a goal with a breadth-first search out from the goal.
+ * @param[in] goalRow The row of the goal.
+ * @param[in] goalCol The column of the goal.
+ * @param[in] occupancy The board's occupancy index, telling which cells are blocked.
+ */
+void DistanceField::build(int goalRow, int goalCol, const vector<unsigned short>& occupancy) {
+    goalCell = goalRow*numCols + goalCol;
+    distance.assign(numRows*numCols, UNREACHABLE);
+    distance[goalCell] = 0;
+
+    pending.clear();
+    pending.push_back(goalCell);
+    relax(occupancy);
+}
+
+
+/**
+ * @brief Repairs the distances after some cells became walkable or blocked.
+ * First every distance that depended on a newly blocked cell is thrown away: a cell keeps its distance only while some neighbor
+ * is still one step closer to the goal. Then the thrown-away cells and the newly walkable ones take their distance from their
+ * neighbors, and any shorter paths they open up are spread outward. Only the part of the board whose distances change is visited,
+ * so opening or closing the gate costs far less than a new build().
+ * A cell may appear more than once in "changedCells", and cells that changed and changed back are harmless.
+ * @param[in] changedCells Row-major indexes of the cells whose passability changed since the last build() or update().
+ * @param[in] occupancy The board's occupancy index, telling which cells are blocked now.
+ */
+void DistanceField::update(const vector<int>& changedCells, const vector<unsigned short>& occupancy) {
+    if (goalCell < 0) return;
+
+    //Throw away the distances of newly blocked cells, remembering what they were.
+    invalidated.clear();
+    for (size_t i=0; i<changedCells.size(); i++) {
+        int cell = changedCells[i];
+        if (! isWalkable(cell, occupancy) && distance[cell] != UNREACHABLE) {
+            invalidated.push_back(cell);
+            invalidated.push_back(distance[cell]);
+            distance[cell] = UNREACHABLE;
+        }
+    }
+
+    //Throw away the distances of cells that were one step farther than a thrown-away cell and have no other neighbor to go through.
+    for (size_t i=0; i<invalidated.size(); i+=2) {
+        int cell = invalidated[i];
+        int oldDistance = invalidated[i+1];
+        int row = cell / numCols;
+        int col = cell % numCols;
+
+        for (int r=max(row-1, 0); r<=min(row+1, numRows-1); r++) {
+            for (int c=max(col-1, 0); c<=min(col+1, numCols-1); c++) {
+                int next = r*numCols + c;
+                if (distance[next] != oldDistance+1) continue;
+
+                bool supported = false;
+                for (int nr=max(r-1, 0); nr<=min(r+1, numRows-1) && !supported; nr++) {
+                    for (int nc=max(c-1, 0); nc<=min(c+1, numCols-1) && !supported; nc++) {
+                        supported = distance[nr*numCols + nc] == oldDistance;
+                    }
+                }
+                if (! supported) {
+                    invalidated.push_back(next);
+                    invalidated.push_back(distance[next]);
+                    distance[next] = UNREACHABLE;
+                }
+            }
+        }
+    }
+
+    //Let the thrown-away cells and the newly walkable ones take the best distance their neighbors offer, then spread it.
+    pending.clear();
+    for (int pass=0; pass<2; pass++) {
+        const vector<int>& cells = (pass == 0) ? changedCells : invalidated;
+        size_t stride = (pass == 0) ? 1 : 2;
+
+        for (size_t i=0; i<cells.size(); i+=stride) {
+            int cell = cells[i];
+            if (! isWalkable(cell, occupancy)) continue;
+            int row = cell / numCols;
+            int col = cell % numCols;
+
+            int best = distance[cell];
+            for (int r=max(row-1, 0); r<=min(row+1, numRows-1); r++) {
+                for (int c=max(col-1, 0); c<=min(col+1, numCols-1); c++) {
+                    int through = distance[r*numCols + c];
+                    if (through != UNREACHABLE && through+1 < best) {
+                        best = through+1;
+                    }
+                }
+            }
+            if (best < distance[cell]) {
+                distance[cell] = best;
+                pending.push_back(cell);
+            }
+        }
+    }
+    relax(occupancy);
+}
+
+
+/**
+ * @brief Spreads the distances of the cells in "pending" to their walkable neighbors, lowering every distance that a path through them shortens.
+ * The cells are taken nearest first, merging the sorted "pending" cells with the breadth-first "frontier" they lead to,
+ * so each cell is normally lowered only once, straight to its final distance.
+ * @param[in] occupancy The board's occupancy index, telling which cells are blocked.
+ */
+void DistanceField::relax(const vector<unsigned short>& occupancy) {
+    const vector<int>& steps = distance;
+    sort(pending.begin(), pending.end(), [&steps](int first, int second) { return steps[first] < steps[second]; });
+    frontier.clear();
+
+    size_t nextPending = 0;
+    size_t nextFrontier = 0;
+    while (nextPending < pending.size() || nextFrontier < frontier.size()) {
+        int cell;
+        if (nextFrontier == frontier.size() || (nextPending < pending.size() && distance[pending[nextPending]] <= distance[frontier[nextFrontier]])) {
+            cell = pending[nextPending++];
+        }
+        else {
+            cell = frontier[nextFrontier++];
+        }
+
+        int row = cell / numCols;
+        int col = cell % numCols;
+        int stepped = distance[cell] + 1;
+
+        for (int r=max(row-1, 0); r<=min(row+1, numRows-1); r++) {
+            for (int c=max(col-1, 0); c<=min(col+1, numCols-1); c++) {
+                int next = r*numCols + c;
+                if (stepped < distance[next] && isWalkable(next, occupancy)) {
+                    distance[next] = stepped;
+                    frontier.push_back(next);
+                }
+            }
+        }
+    }
+    pending.clear();
+    frontier.clear();
+}
+
+
+/**
+ * @brief Tells whether a path to the goal may go through a cell.
+ * The goal itself always counts, so that goals placed on blocked cells (the ingredients) can still be reached by standing next to them.
+ * @param[in] cell The row-major index of the cell.
+ * @param[in] occupancy The board's occupancy index.
+ * @return Whether the cell can be walked through.
+ */
+bool DistanceField::isWalkable(int cell, const vector<unsigned short>& occupancy) const {
+    return cell == goalCell || ! (occupancy[cell] & Board::CELL_BLOCKED);
+}
@@ -0,0 +1,63 @@
+/**
+ * @file DistanceField.h
+ * @brief The DistanceField class declaration file.
+ */
+
+#ifndef DISTANCEFIELD_H
+#define DISTANCEFIELD_H
+
+#include <vector>
+
+using namespace std;
+
+/**
+ * @class DistanceField
+ * @brief The number of steps from every cell of the board to one goal cell, walking in any of the 8 directions.
+ * Only walkable cells are stepped through; the goal cell itself counts as reached even if it cannot be walked on
+ * (an ingredient, for example). Built with a breadth-first search, and repaired in place when cells change between walkable
+ * and blocked, so following it downhill is always a shortest path around the walls.
+ * Walkability is read from a board's occupancy index (cells with Board::CELL_BLOCKED set are blocked).
+ */
+class DistanceField {
+    public:
+    DistanceField(int numRows, int numCols);
+
+    //Distance of cells the goal cannot be reached from.
+    static const int UNREACHABLE = 0x3fffffff;
+
+    //Compute every distance to the goal at (goalRow, goalCol) from scratch.
+    void build(int goalRow, int goalCol, const vector<unsigned short>& occupancy);
+
+    //Bring the distances up to date after the cells in "changedCells" (row-major indexes) became walkable or blocked.
+    void update(const vector<int>& changedCells, const vector<unsigned short>& occupancy);
+
+    //Steps from (row, col) to the goal, or UNREACHABLE. (row, col) must be on the board.
+    int at(int row, int col) const { return distance[row*numCols + col]; }
+
+
+    protected:
+    //Spread the distances of the cells in "pending" to everything a path through them gets closer, until nothing can be lowered further.
+    void relax(const vector<unsigned short>& occupancy);
+
+    //Whether a cell can be stepped through.
+    bool isWalkable(int cell, const vector<unsigned short>& occupancy) const;
+
+    //Board dimensions.
+    int numRows;
+    int numCols;
+
+    //Row-major index of the goal cell, or -1 before build().
+    int goalCell;
+
+    //Steps to the goal from each cell, row-major.
+    vector<int> distance;
+
+    //Cells whose distance relax() still has to spread, and the cells relax() lowered on the way. Reused between calls.
+    vector<int> pending;
+    vector<int> frontier;
+
+    //Cells whose distance update() threw away, each followed by the distance it had. Reused between calls.
+    vector<int> invalidated;
+};
+
+#endif // DISTANCEFIELD_H
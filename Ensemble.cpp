@@ -0,0 +1,193 @@
+/**
+ * @file Ensemble.cpp
+ * @brief The Ensemble class implementation file.
+ */
+
+#include <algorithm>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "Ensemble.h"
+
+using namespace std;
+
+/**
+ * @brief The Ensemble class constructor.
+ * Records the scenario that every run will play.
+ *
+ * @param rows The number of rows in each board.
+ * @param cols The number of columns in each board.
+ * @param humans The number of humans on each board.
+ * @param doctors The number of doctors on each board.
+ * @param scavengers The number of scavengers sent out on each board.
+ * @param ticks The last time unit each run may reach.
+ */
+Ensemble::Ensemble(int rows, int cols, int humans, int doctors, int scavengers, int ticks) {
+    numRows = rows;
+    numCols = cols;
+    numHumans = humans;
+    numDoctors = doctors;
+    numScavengers = scavengers;
+    tickLimit = ticks;
+    baseSeed = 0;
+    numRuns = 0;
+    nextRun = 0;
+}
+
+
+/**
+ * @brief Plays every run of the ensemble.
+ * Starts "numThreads" worker threads that pull run numbers until all runs are done, then waits for them.
+ * Each run's random stream is split off a generator seeded with "seed" before any thread starts,
+ * so results depend only on the seed and never on the number of threads.
+ * @param[in] runs The number of games to play.
+ * @param[in] numThreads The number of worker threads (at least 1).
+ * @param[in] seed The seed of the generator the run streams are split from.
+ */
+void Ensemble::run(int runs, int numThreads, uint64_t seed) {
+    numRuns = runs;
+    baseSeed = seed;
+    nextRun = 0;
+    results.assign(numRuns, RunSummary());
+
+    //Give every run its own non-overlapping stream.
+    Random master(baseSeed);
+    streams.clear();
+    for (int i=0; i<numRuns; i++) {
+        streams.push_back(master.split());
+    }
+
+    if (numThreads < 1) {
+        numThreads = 1;
+    }
+
+    vector<thread> threads;
+    for (int i=0; i<numThreads; i++) {
+        threads.push_back(thread(&Ensemble::worker, this));
+    }
+    for (int i=0; i<numThreads; i++) {
+        threads[i].join();
+    }
+}
+
+
+/**
+ * @brief The loop each worker thread runs.
+ * Claims run numbers from "nextRun" one at a time and plays them.
+ * Every run on the thread shares one FieldCache, since they all have the scenario's walls and gate.
+ */
+void Ensemble::worker() {
+    FieldCache fields;
+    int index;
+    while ((index = nextRun++) < numRuns) {
+        playRun(index, fields);
+    }
+}
+
+
+/**
+ * @brief Plays a single headless game and stores its summary.
+ * @param[in] index The run number.
+ * @param[in,out] fields The thread's goal distance fields.
+ */
+void Ensemble::playRun(int index, FieldCache& fields) {
+    Board board(numRows, numCols, numHumans, numDoctors);
+    board.setHeadless(true);
+    board.setNumScavengers(numScavengers);
+    board.setTickLimit(tickLimit);
+    board.setRandom(streams[index]);
+    board.setFieldCache(&fields);
+
+    board.run();
+
+    results[index] = board.getSummary();
+}
+
+
+/**
+ * @brief Prints the aggregated results of the last run() as one line of JSON.
+ * Includes how many runs ended each way, and the distributions of the ending time unit and of the final infected count.
+ * @param[out] out The stream to print to.
+ */
+void Ensemble::printReport(ostream& out) {
+    int vaccine = 0, infection = 0, timeLimit = 0;
+    int reasons[REASON_TIME_LIMIT+1] = {0};
+    vector<int> endTicks;
+    vector<int> infected;
+
+    for (int i=0; i<numRuns; i++) {
+        switch (results[i].outcome) {
+            case OUTCOME_VACCINE:
+                vaccine++;
+                break;
+            case OUTCOME_INFECTION:
+                infection++;
+                break;
+            case OUTCOME_TIME_LIMIT:
+                timeLimit++;
+                break;
+            case OUTCOME_IN_PROGRESS:
+                //Every run of an ensemble is played to the end.
+                break;
+        }
+        reasons[results[i].reason]++;
+        endTicks.push_back(results[i].endTick);
+        infected.push_back(results[i].numInfected);
+    }
+
+    out << "{\"runs\":" << numRuns
+        << ",\"baseSeed\":" << baseSeed
+        << ",\"outcomes\":{\"vaccine\":" << vaccine
+        << ",\"infection\":" << infection
+        << ",\"time_limit\":" << timeLimit << "}"
+        << ",\"reasons\":{";
+    for (int reason=0; reason<=REASON_TIME_LIMIT; reason++) {
+        out << (reason > 0 ? "," : "") << "\"" << reasonName(OutcomeReason(reason)) << "\":" << reasons[reason];
+    }
+    out << "}"
+        << ",\"endTick\":";
+    printDistribution(out, endTicks);
+    out << ",\"infected\":";
+    printDistribution(out, infected);
+    out << "}" << endl;
+}
+
+
+/**
+ * @brief Gives the nearest-rank percentile of sorted values: the smallest value that at least "percent" percent of them are at or below.
+ * @param[in] values The values, sorted, and at least one.
+ * @param[in] percent The percentile, from 1 to 100.
+ * @return The value at rank ceil(percent/100 * n), counting from 1.
+ */
+static int percentile(const vector<int>& values, int percent) {
+    size_t rank = (percent*values.size() + 99) / 100;
+    return values[rank-1];
+}
+
+
+/**
+ * @brief Prints a summary of a list of values as a JSON object.
+ * @param[out] out The stream to print to.
+ * @param[in] values The values to summarize (a copy, since it gets sorted).
+ */
+void Ensemble::printDistribution(ostream& out, vector<int> values) {
+    if (values.empty()) {
+        out << "{}";
+        return;
+    }
+
+    sort(values.begin(), values.end());
+
+    double total = 0;
+    for (size_t i=0; i<values.size(); i++) {
+        total += values[i];
+    }
+
+    out << "{\"min\":" << values[0]
+        << ",\"p10\":" << percentile(values, 10)
+        << ",\"p50\":" << percentile(values, 50)
+        << ",\"p90\":" << percentile(values, 90)
+        << ",\"max\":" << values.back()
+        << ",\"mean\":" << total/values.size() << "}";
+}
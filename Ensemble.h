@@ -0,0 +1,66 @@
+/**
+ * @file Ensemble.h
+ * @brief The Ensemble class declaration file.
+ */
+
+#ifndef ENSEMBLE_H
+#define ENSEMBLE_H
+
+#include <atomic>
+#include <iostream>
+#include <vector>
+
+#include "Board.h"
+
+using namespace std;
+
+/**
+ * @class Ensemble
+ * @brief Runs many independent headless games of one scenario across a pool of threads and summarizes the results.
+ * Every run gets its own Board and its own random stream, and writes its result to its own slot, so the threads share no mutable state
+ * apart from the counter that hands out run numbers.
+ */
+class Ensemble {
+    public:
+    Ensemble(int numRows, int numCols, int numHumans, int numDoctors, int numScavengers, int tickLimit);
+
+    //Play "numRuns" games on "numThreads" threads. Run i uses the i-th stream split from a generator seeded with baseSeed.
+    void run(int numRuns, int numThreads, uint64_t baseSeed);
+
+    //Print the aggregated results as one line of JSON.
+    void printReport(ostream& out);
+
+
+    protected:
+    //Loop run by each thread: claim the next run number and play it, until none are left.
+    void worker();
+
+    //Play run number "index" on its own Board, sharing the thread's goal distance fields in "fields".
+    void playRun(int index, FieldCache& fields);
+
+    //Print min, mean, percentiles, and max of a list of values as a JSON object.
+    void printDistribution(ostream& out, vector<int> values);
+
+    //Scenario shared by every run.
+    int numRows;
+    int numCols;
+    int numHumans;
+    int numDoctors;
+    int numScavengers;
+    int tickLimit;
+
+    //Seed of the generator the run streams are split from.
+    uint64_t baseSeed;
+
+    //Random stream of each run, indexed by run number.
+    vector<Random> streams;
+
+    //Number of runs, and the next run number to hand out.
+    int numRuns;
+    atomic<int> nextRun;
+
+    //Result of each run, indexed by run number.
+    vector<RunSummary> results;
+};
+
+#endif // ENSEMBLE_H
@@ -0,0 +1,120 @@
+/**
+ * @file FieldCache.cpp
+ * @brief The FieldCache class implementation file.
+ */
+
+#include "Board.h"
+#include "FieldCache.h"
+#include "Random.h"
+
+using namespace std;
+
+/**
+ * @brief The FieldCache class constructor. The cache starts out empty.
+ */
+FieldCache::FieldCache() {
+    numCells = 0;
+}
+
+
+/**
+ * @brief Looks up, or builds and keeps, the field to a goal on a board's layout, and copies it out.
+ * The layout is the board's blocked cells with the ingredient cells cleared. Layouts are found by a hash of their cells, and
+ * only compared cell by cell with the one of the same hash, which costs far less than building a field.
+ * @param[in] goalRow The row of the goal.
+ * @param[in] goalCol The column of the goal.
+ * @param[in] numRows The number of rows in the board.
+ * @param[in] numCols The number of columns in the board.
+ * @param[in] occupancy The board's occupancy index.
+ * @param[in] ingredientCells Row-major indexes of the cells to treat as walkable.
+ * @param[out] field The field to the goal on the layout.
+ */
+void FieldCache::fetch(int goalRow, int goalCol, int numRows, int numCols, const vector<unsigned short>& occupancy,
+                       const vector<int>& ingredientCells, DistanceField& field) {
+    blocked.resize(occupancy.size());
+    for (size_t cell=0; cell<occupancy.size(); cell++) {
+        blocked[cell] = (occupancy[cell] & Board::CELL_BLOCKED) != 0;
+    }
+    for (size_t i=0; i<ingredientCells.size(); i++) {
+        blocked[ingredientCells[i]] = 0;
+    }
+    uint64_t layout = hashLayout(blocked);
+
+    //Another layout with the same hash gives way to this one, fields and all.
+    map<uint64_t, CachedLayout>::iterator known = layouts.find(layout);
+    if (known != layouts.end() && known->second.blocked != blocked) {
+        for (list<CachedField>::iterator kept = fields.begin(); kept != fields.end(); ) {
+            if (kept->layout == layout) {
+                numCells -= known->second.blocked.size();
+                fieldIndex.erase(make_pair(layout, kept->goalCell));
+                kept = fields.erase(kept);
+            }
+            else {
+                kept++;
+            }
+        }
+        layouts.erase(known);
+    }
+
+    int goalCell = goalRow*numCols + goalCol;
+    map<pair<uint64_t, int>, list<CachedField>::iterator>::iterator found = fieldIndex.find(make_pair(layout, goalCell));
+    if (found != fieldIndex.end()) {
+        fields.splice(fields.begin(), fields, found->second);
+        field = found->second->field;
+        return;
+    }
+
+    layoutOccupancy.resize(blocked.size());
+    for (size_t cell=0; cell<blocked.size(); cell++) {
+        layoutOccupancy[cell] = blocked[cell] ? Board::CELL_BLOCKED : 0;
+    }
+    field = DistanceField(numRows, numCols);
+    field.build(goalRow, goalCol, layoutOccupancy);
+
+    CachedLayout& kept = layouts[layout];
+    if (kept.numFields == 0) {
+        kept.blocked = blocked;
+    }
+    kept.numFields++;
+    fields.push_front(CachedField(layout, goalCell, field));
+    fieldIndex[make_pair(layout, goalCell)] = fields.begin();
+    numCells += blocked.size();
+
+    //Keep at least the field just built, however big.
+    while (numCells > MAX_CELLS && fields.size() > 1) {
+        dropOldestField();
+    }
+}
+
+
+/**
+ * @brief Hashes a layout's blocked cells, 64 cells at a time.
+ * @param[in] blocked Nonzero for each blocked cell, row-major.
+ * @return The hash.
+ */
+uint64_t FieldCache::hashLayout(const vector<unsigned char>& blocked) {
+    uint64_t hash = blocked.size();
+    for (size_t first=0; first<blocked.size(); first+=64) {
+        uint64_t word = 0;
+        for (size_t cell=first; cell<blocked.size() && cell<first+64; cell++) {
+            word |= uint64_t(blocked[cell] != 0) << (cell - first);
+        }
+        hash = Random::hash(hash, word);
+    }
+    return hash;
+}
+
+
+/**
+ * @brief Forgets the field used longest ago, and its layout once no kept field is built on it.
+ */
+void FieldCache::dropOldestField() {
+    CachedField& oldest = fields.back();
+    map<uint64_t, CachedLayout>::iterator layout = layouts.find(oldest.layout);
+    numCells -= layout->second.blocked.size();
+    if (--layout->second.numFields == 0) {
+        layouts.erase(layout);
+    }
+    fieldIndex.erase(make_pair(oldest.layout, oldest.goalCell));
+    fields.pop_back();
+}
@@ -0,0 +1,86 @@
+/**
+ * @file FieldCache.h
+ * @brief The FieldCache class declaration file.
+ */
+
+#ifndef FIELDCACHE_H
+#define FIELDCACHE_H
+
+#include <stdint.h>
+#include <list>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "DistanceField.h"
+
+using namespace std;
+
+/**
+ * @brief One board layout that has fields in a FieldCache.
+ */
+struct CachedLayout {
+    vector<unsigned char> blocked;      // Nonzero for each blocked cell of the layout, row-major
+    int numFields;                      // How many of the cache's fields are built on this layout
+
+    CachedLayout() : numFields(0) {}
+};
+
+/**
+ * @brief A distance field kept by a FieldCache, and what it was built for.
+ */
+struct CachedField {
+    uint64_t layout;                    // Hash of the layout the field was built on
+    int goalCell;                       // Row-major goal cell
+    DistanceField field;                // The distances
+
+    CachedField(uint64_t layout, int goalCell, const DistanceField& field) : layout(layout), goalCell(goalCell), field(field) {}
+};
+
+/**
+ * @class FieldCache
+ * @brief Distance fields shared by many boards of the same scenario, so each is only built once.
+ * Every board of a scenario has the same walls, gate, and research facility; only the vaccine ingredients are placed at random.
+ * So the cache keeps fields of the layout with the ingredient cells left walkable, and a board repairs a copy for its own
+ * ingredients with DistanceField::update(), which gives exactly the field a fresh build would.
+ * Fields are kept up to MAX_CELLS cells in all, and the one used longest ago is dropped first, so the gate and research facility
+ * fields, which every board asks for, stay while the ingredient fields come and go. A cache is not thread safe.
+ */
+class FieldCache {
+    public:
+    FieldCache();
+
+    //The most distances the cache keeps, over all its fields: 16 MB of them.
+    static const size_t MAX_CELLS = 1 << 22;
+
+    //Copy into "field" the distances to (goalRow, goalCol) on the board "occupancy" describes, but with the cells in
+    //"ingredientCells" walkable. The field is built if the cache does not have it.
+    void fetch(int goalRow, int goalCol, int numRows, int numCols, const vector<unsigned short>& occupancy,
+               const vector<int>& ingredientCells, DistanceField& field);
+
+
+    protected:
+    //Hash of a layout's blocked cells.
+    static uint64_t hashLayout(const vector<unsigned char>& blocked);
+
+    //Forget the field used longest ago, and its layout if no other field is built on it.
+    void dropOldestField();
+
+    //The layouts the kept fields are built on, by hash.
+    map<uint64_t, CachedLayout> layouts;
+
+    //The kept fields, the most recently used first.
+    list<CachedField> fields;
+
+    //Where each kept field is in "fields", by layout hash and goal cell.
+    map<pair<uint64_t, int>, list<CachedField>::iterator> fieldIndex;
+
+    //How many distances the kept fields hold in all.
+    size_t numCells;
+
+    //Reused copies of the layout being looked up, as blocked flags and as an occupancy index to build fields on.
+    vector<unsigned char> blocked;
+    vector<unsigned short> layoutOccupancy;
+};
+
+#endif // FIELDCACHE_H
@@ -0,0 +1,84 @@
+/**
+ * @file FrameExchange.cpp
+ * @brief The FrameExchange class implementation file.
+ */
+
+#include "FrameExchange.h"
+
+using namespace std;
+
+
+/**
+ * @brief The FrameExchange class constructor.
+ * Slot 0 belongs to the simulation thread, slot 1 sits in the middle, and slot 2 belongs to the render thread.
+ */
+FrameExchange::FrameExchange() : middle(1) {
+    writeIndex = 0;
+    readIndex = 2;
+}
+
+
+/**
+ * @brief Sizes every slot for a frame. Call before either thread starts using the exchange.
+ * @param[in] cells The number of cells in a frame.
+ */
+void FrameExchange::resize(int cells) {
+    for (int i=0; i<3; i++) {
+        slots[i].assign(cells, ScreenCell());
+    }
+    middle.store(1);
+    writeIndex = 0;
+    readIndex = 2;
+}
+
+
+/**
+ * @brief Gives the simulation thread its slot to draw the next frame into.
+ * @return The slot, which holds an old frame until it is redrawn.
+ */
+vector<ScreenCell>& FrameExchange::writeSlot() {
+    return slots[writeIndex];
+}
+
+
+/**
+ * @brief Publishes the frame in the write slot.
+ * The write slot becomes the middle slot, and the simulation thread gets the old middle slot to draw into next.
+ * An unshown frame already in the middle is simply replaced.
+ */
+void FrameExchange::publish() {
+    int previous = middle.exchange(writeIndex | FRESH, memory_order_acq_rel);
+    writeIndex = previous & SLOT_MASK;
+}
+
+
+/**
+ * @brief Tells whether the last published frame has been taken by the render thread.
+ * Lets the simulation thread skip drawing frames that would only be replaced before being shown.
+ * @return true if the middle slot holds no unshown frame.
+ */
+bool FrameExchange::wantsFrame() const {
+    return (middle.load(memory_order_acquire) & FRESH) == 0;
+}
+
+
+/**
+ * @brief Takes the newest published frame for the render thread.
+ * @return true if a new frame is now in the read slot; false if nothing was published since the last call.
+ */
+bool FrameExchange::acquire() {
+    if ((middle.load(memory_order_acquire) & FRESH) == 0) return false;
+
+    int previous = middle.exchange(readIndex, memory_order_acq_rel);
+    readIndex = previous & SLOT_MASK;
+    return true;
+}
+
+
+/**
+ * @brief Gives the render thread the slot holding the last acquired frame.
+ * @return The slot. The render thread may modify it freely.
+ */
+vector<ScreenCell>& FrameExchange::readSlot() {
+    return slots[readIndex];
+}
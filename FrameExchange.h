@@ -0,0 +1,58 @@
+/**
+ * @file FrameExchange.h
+ * @brief The FrameExchange class declaration file.
+ */
+
+#ifndef FRAMEEXCHANGE_H
+#define FRAMEEXCHANGE_H
+
+#include <atomic>
+#include <vector>
+
+#include "Screen.h"
+
+using namespace std;
+
+/**
+ * @class FrameExchange
+ * @brief A lock-free triple buffer that hands finished frames from the simulation thread to the render thread.
+ * The simulation thread fills its own slot and publishes it, which swaps it with the shared middle slot.
+ * The render thread acquires the middle slot whenever a newer frame has been published.
+ * Neither side ever waits for the other, and each slot belongs to exactly one side at a time,
+ * so a published frame is never modified while it is being shown.
+ */
+class FrameExchange {
+    public:
+    FrameExchange();
+
+    //Give all three slots room for a frame of "cells" cells.
+    void resize(int cells);
+
+    //Simulation side: the slot to draw into, and handing it over once finished.
+    vector<ScreenCell>& writeSlot();
+    void publish();
+
+    //Simulation side: whether the render thread has taken the last published frame.
+    bool wantsFrame() const;
+
+    //Render side: take the newest published frame, if there is one, and the slot holding it.
+    bool acquire();
+    vector<ScreenCell>& readSlot();
+
+
+    protected:
+    //Set in "middle" when the middle slot holds a frame the render thread has not taken yet.
+    static const int FRESH = 4;
+    static const int SLOT_MASK = 3;
+
+    vector<ScreenCell> slots[3];
+
+    //Slot owned by the simulation thread, and slot owned by the render thread.
+    int writeIndex;
+    int readIndex;
+
+    //Slot in the middle, plus the FRESH flag. The only state both threads touch.
+    atomic<int> middle;
+};
+
+#endif // FRAMEEXCHANGE_H
@@ -13,57 +13,48 @@
 #include <cmath>
 
 #include "Human.h"
-#include "conio.h"
 
 using namespace std;
 
 /**
  * @brief The Human class constructor.
- * This function initializes the row, col, infected, and board variables.
- * As well as the object type ("Human").
+ * This function initializes the id, agents, and board variables.
+ * The human's row, column, infection status, and role already live in the board's AgentStore under "agentId".
  *
- * @param initRow The initial human row location.
- * @param initCol The initial human column location.
- * @param initInfected Whether the human is initially infected.
+ * @param agentId The id of this human's agent in the board's AgentStore.
  * @param theBoard A pointer to the board (used to ask board whether a proposed move is ok).
  */
-Human::Human(int initRow, int initCol, bool initInfected, Board* theBoard) {
+Human::Human(int agentId, Board* theBoard) {
     //Initialize to parameters.
-    row = initRow;
-    col = initCol;
-    infected = initInfected;
+    id = agentId;
     board = theBoard;
-
-    //Initialize string of object type.
-    objectType = "Human";
-}
-
-
-/**
- * @brief The Human class destructor.
- */
-Human::~Human() {
-    // Nothing to do
+    agents = &board->getAgents();
 }
 
 
 /**
- * @brief Have the human try to move.
+ * @brief Have the human choose where to try to move.
  * To know whether it is ok to move to some position (r,c), ask the board
  * whether the position is ok. E.g., "if( board->tryMove(r,c) ) ..."
- * If the move is ok, then update the human's row and column to reflect the move.
+ * Nothing is changed here; the board moves the human to the chosen location afterwards (see Board::tick()).
+ * Because it only reads the board, many humans can choose their moves at the same time.
+ * @param[in,out] dice Random numbers for the move.
+ * @param[out] row The row to move to (the current row if the human stays).
+ * @param[out] col The column to move to (the current column if the human stays).
  */
-void Human::move() {
+void Human::proposeMove(Random& dice, int& row, int& col) {
     int rowDelta, colDelta;
+    row = agents->row[id];
+    col = agents->col[id];
 
     //Generate a +/- 2 row and column delta.
-    rowDelta=rand()%5-2;
-    colDelta=rand()%5-2;
+    rowDelta=dice.nextInt()%5-2;
+    colDelta=dice.nextInt()%5-2;
 
     //Ask the board whether the move is okay.
     if(board->tryMove(row+rowDelta, col+colDelta)) {
-        row+=rowDelta;
-        col+=colDelta;
+        row += rowDelta;
+        col += colDelta;
     }
 }
 
@@ -75,20 +66,8 @@ void Human::move() {
  * @param[out] currentCol The human's current column.
  */
 void Human::getLocation(int& currentRow, int& currentCol) {
-    currentRow = row;
-    currentCol = col;
-}
-
-
-/**
- * @brief Set the human's row/col location.
- * Sets the human's current row/column location to the parameter values.
- * @param[in] newRow The human's new row location.
- * @param[in] newCol The human's new column location.
- */
-void Human::setLocation(int newRow, int newCol) {
-    row=newRow;
-    col=newCol;
+    currentRow = agents->row[id];
+    currentCol = agents->col[id];
 }
 
 
@@ -97,7 +76,7 @@ void Human::setLocation(int newRow, int newCol) {
  * Sets this human object's state to infected.
  */
 void Human::setInfected() {
-    infected = true;
+    agents->infected[id] = true;
 }
 
 
@@ -106,7 +85,7 @@ void Human::setInfected() {
  * Sets this human object's state to uninfected.
  */
 void Human::setUnInfected() {
-    infected = false;
+    agents->infected[id] = false;
 }
 
 
@@ -115,161 +94,41 @@ void Human::setUnInfected() {
  * @return Whether this human object is infected.
  */
 bool Human::isInfected() {
-    return infected;
+    return agents->infected[id];
 }
 
 
 /**
- * @brief Draws the human.
- * Draws the human at the current row/col location on the screen.
- * Draws light red if infected, green otherwise.
- * Remember that the first conio row=1, and the first conio col=1.
+ * @brief Reports which agent of the board's AgentStore this human views.
+ * @return The agent id.
  */
-void Human::draw() {
-    cout << conio::gotoRowCol(row+1,col+1);
-
-    //Infected
-    if(infected) {
-        cout << conio::bgColor(conio::LIGHT_RED);
-        cout << '@' << conio::resetAll() << flush;
-    }
-    //Healthy
-    else {
-        cout << conio::bgColor(conio::LIGHT_GREEN);
-        cout << '@' << conio::resetAll() << flush;
-    }
+int Human::getId() {
+    return id;
 }
 
 
 /**
- * @brief Returns the class name/ data type of the object.
+ * @brief Reports this human's role.
  * Used to distinguish between regular humans, doctors, and scavengers.
- * @return The type (class name) of the object.
- */
-string Human::getObjectType() {
-    return objectType;
-}
-
-
-/**
- * @brief Sets the row and column of the first vaccine ingredient.
- * Used exclusively by the derived Scavenger class.
- * Used as a goal point to pathfind to, as well as track if the scavenger is touching this goal point.
- * @param[in] row The row of the first ingredient.
- * @param[in] col The column of the first ingredient.
- */
-void Human::setFirstIngredientRowCol(int row, int col) {
-}
-
-
-/**
- * @brief Sets the row and column of the second vaccine ingredient.
- * Used exclusively by the derived Scavenger class.
- * Used as a goal point to pathfind to, as well as track if the scavenger is touching this goal point.
- * @param[in] row The row of the second ingredient.
- * @param[in] col The column of the second ingredient.
- */
-void Human::setSecondIngredientRowCol(int row, int col) {
-}
-
-
-/**
- * @brief Sets the row and column of the middle of the city gate.
- * Used exclusively by the derived Scavenger class.
- * Used as a goal point to pathfind to, as well as track if the scavenger is touching this goal point.
- * @param[in] row The row of the city gate.
- * @param[in] col The column of the city gate.
- */
-void Human::setGateRowCol(int row, int col) {
-}
-
-
-/**
- * @brief Sets the row and column of a point in the research facility.
- * Used exclusively by the derived Scavenger class.
- * Used as a goal point to pathfind to, as well as track if the scavenger is touching this goal point.
- * @param[in] row The row of the research facility.
- * @param[in] col The column of the research facility.
- */
-void Human::setResearchFacilityRowCol(int row, int col) {
-}
-
-
-/**
- * @brief Moves the object toward a goal point.
- * Used exclusively by the derived Scavenger class in its move() function.
- * @param[in] goalRow The row of a goal point.
- * @param[in] goalCol The column of a goal point.
- */
-void Human::doPathFindingMove(int goalRow, int goalCol) {
-}
-
-
-/**
- * @brief Setter for the Scavenger boolean "hasReachedGate".
- * Sets the value to the value of "boolean".
- * Used exclusively by the derived Scavenger class.
- * @param[in] boolean The value to be assigned to "hasReachedGate".
- */
-void Human::setHasReachedGate(bool boolean) {
-}
-
-
-/**
- * @brief Setter for the Scavenger boolean "hasFirstIngredient".
- * Sets the value to the value of "boolean".
- * Used exclusively by the derived Scavenger class.
- * @param[in] boolean The value to be assigned to "hasFirstIngredient".
- */
-void Human::setHasFirstIngredient(bool boolean) {
-}
-
-
-/**
- * @brief Setter for the Scavenger boolean "hasSecondIngredient".
- * Sets the value to the value of "boolean".
- * Used exclusively by the derived Scavenger class.
- * @param[in] boolean The value to be assigned to "hasSecondIngredient".
+ * @return The AgentRole stored for this human's agent.
  */
-void Human::setHasSecondIngredient(bool boolean) {
+AgentRole Human::getRole() {
+    return AgentRole(agents->role[id]);
 }
 
 
 /**
- * @brief Setter for the Scavenger boolean "hasReachedResearchFacility".
- * Sets the value to the value of "boolean".
- * Used exclusively by the derived Scavenger class.
- * @param[in] boolean The value to be assigned to "hasReachedResearchFacility".
- */
-void Human::setHasReachedResearchFacility(bool boolean) {
-}
-
-
-/**
- * @brief Getter for the Scavenger boolean "hasFirstIngredient".
- * Used exclusively by the derived Scavenger class.
- * @return By default returns false.
- */
-bool Human::getHasFirstIngredient() {
-    return false;
-}
-
-
-/**
- * @brief Getter for the Scavenger boolean "hasSecondIngredient".
- * Used exclusively by the derived Scavenger class.
- * @return By default returns false.
- */
-bool Human::getHasSecondIngredient() {
-    return false;
-}
-
-
-/**
- * @brief Getter for the Scavenger boolean "hasReachedResearchFacility".
- * Used exclusively by the derived Scavenger class.
- * @return By default returns false.
+ * @brief Returns the class name/ data type of the object.
+ * Derived from getRole(). Meant for display only; compare getRole() instead.
+ * @return The type (class name) of the object: "Human", "Doctor", or "Scavenger".
  */
-bool Human::getHasReachedResearchFacility() {
-    return false;
+string Human::getObjectType() {
+    switch (getRole()) {
+        case ROLE_DOCTOR:
+            return "Doctor";
+        case ROLE_SCAVENGER:
+            return "Scavenger";
+        default:
+            return "Human";
+    }
 }
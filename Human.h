@@ -8,6 +8,8 @@
  */
 
 #include "Board.h"
+#include "AgentStore.h"
+#include "Random.h"
 #include <string>
 
 #ifndef HUMAN_H
@@ -18,50 +20,36 @@ using namespace std;
 /**
  * @class Human
  * @brief The Human class declaration.
+ * A Human is a view onto one agent of the board's AgentStore; the agent's state lives in the store.
+ * Views are cheap to build, so the board makes one whenever it needs to move an agent, instead of keeping one per agent.
  */
 class Human {
     public:
-    Human(int initRow, int initCol, bool initInfected, Board* thisBoard);
-	virtual ~Human();
+    Human(int agentId, Board* thisBoard);
 
-    //Basic move and draw functions for Human and derived classes
-	virtual void move();
-	virtual void draw();
+    //Basic move function, shared by regular humans and doctors.
+    //Only chooses the new location (using "dice" for randomness); the board carries out the move.
+    //Not virtual: the board picks the class to move an agent with from its role (see Board::moveInTurn()).
+	void proposeMove(Random& dice, int& row, int& col);
 
 	//Setters and getters for Human class and derived classes
-	virtual void getLocation(int& row, int& col);
-	virtual void setLocation(int row, int col);
-	virtual void setInfected();
-    virtual void setUnInfected();
-	virtual bool isInfected();
-    virtual string getObjectType();
+	void getLocation(int& row, int& col);
+	void setInfected();
+    void setUnInfected();
+	bool isInfected();
+    int getId();
+    AgentRole getRole();
 
-    //Setters and getters to be used exlusively by the Scavenger class
-    virtual void setFirstIngredientRowCol(int row, int col);
-    virtual void setSecondIngredientRowCol(int row, int col);
-    virtual void setGateRowCol(int row, int col);
-    virtual void setResearchFacilityRowCol(int row, int col);
-    virtual void setHasReachedGate(bool boolean);
-    virtual void setHasFirstIngredient(bool boolean);
-    virtual void setHasSecondIngredient(bool boolean);
-    virtual void setHasReachedResearchFacility(bool boolean);
-    virtual bool getHasFirstIngredient();
-    virtual bool getHasSecondIngredient();
-    virtual bool getHasReachedResearchFacility();
-
-    //Move function used exlusively by the Scavenger class
-    virtual void doPathFindingMove(int goalRow, int goalCol);
+    //Class name for display only ("Human", "Doctor", "Scavenger").
+    string getObjectType();
 
 
     protected:
-    //Track whether or not this human is infected.
-    bool infected;     
-
-    //The row and column where this human is on the board.
-	int row, col;      
+    //Id of this human's agent in the board's AgentStore.
+    int id;
 
-    //String used to keep track of the class to which an object belongs. Possible values: "Human", "Doctor", "Scavenger". 
-    string objectType; 
+    //The board's AgentStore, which holds this human's row, column, and infection status.
+    AgentStore* agents;
 
     //Pointer to the board so the human can ask the board whether the human can move to a given location on the board.
 	Board *board;      
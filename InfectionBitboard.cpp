@@ -0,0 +1,105 @@
+/**
+ * @file InfectionBitboard.cpp
+ * @brief The InfectionBitboard class implementation file.
+ */
+
+#include <algorithm>
+
+#include "InfectionBitboard.h"
+
+using namespace std;
+
+/**
+ * @brief The InfectionBitboard class constructor.
+ * Allocates every plane, all initially clear.
+ *
+ * @param rows The number of rows in the board.
+ * @param cols The number of columns in the board.
+ */
+InfectionBitboard::InfectionBitboard(int rows, int cols) {
+    numRows = rows;
+    numCols = cols;
+    wordsPerRow = (numCols+63)/64;
+
+    int words = numRows*wordsPerRow;
+    infected.assign(words, 0);
+    healthy.assign(words, 0);
+    doctors.assign(words, 0);
+    newInfections.assign(words, 0);
+    newHeals.assign(words, 0);
+    nearInfected.assign(words, 0);
+    nearDoctor.assign(words, 0);
+    sideways.assign(words, 0);
+}
+
+
+/**
+ * @brief Clears the infected, healthy, and doctor planes, ready for everyone to be added again.
+ */
+void InfectionBitboard::clear() {
+    fill(infected.begin(), infected.end(), 0);
+    fill(healthy.begin(), healthy.end(), 0);
+    fill(doctors.begin(), doctors.end(), 0);
+}
+
+
+/**
+ * @brief Works out the infections and heals of one time unit, all at once.
+ * Healthy humans next to an infected are infected, unless a doctor is next to them too; infected humans next to a doctor are healed.
+ * Everything is judged from where everyone stood at the start, so the order the humans are in does not matter.
+ */
+void InfectionBitboard::spread() {
+    dilate(infected, nearInfected);
+    dilate(doctors, nearDoctor);
+
+    for (size_t word=0; word<newInfections.size(); word++) {
+        newInfections[word] = healthy[word] & nearInfected[word] & ~nearDoctor[word];
+        newHeals[word] = infected[word] & nearDoctor[word];
+    }
+}
+
+
+/**
+ * @brief Spreads every set bit of a plane to its 3x3 block.
+ * Each row is first spread sideways, carrying the bits that cross between words, and then each row is ORed with the rows above and below.
+ * Bits past the last column may be set in "out"; they are never read.
+ * @param[in] plane The plane to spread.
+ * @param[out] out The spread plane.
+ */
+void InfectionBitboard::dilate(const vector<uint64_t>& plane, vector<uint64_t>& out) {
+    for (int row=0; row<numRows; row++) {
+        const uint64_t* in = &plane[row*wordsPerRow];
+        uint64_t* side = &sideways[row*wordsPerRow];
+        for (int word=0; word<wordsPerRow; word++) {
+            uint64_t left = (in[word] << 1) | (word > 0 ? in[word-1] >> 63 : 0);
+            uint64_t right = (in[word] >> 1) | (word+1 < wordsPerRow ? in[word+1] << 63 : 0);
+            side[word] = in[word] | left | right;
+        }
+    }
+
+    for (int row=0; row<numRows; row++) {
+        for (int word=0; word<wordsPerRow; word++) {
+            uint64_t bits = sideways[row*wordsPerRow + word];
+            if (row > 0) bits |= sideways[(row-1)*wordsPerRow + word];
+            if (row+1 < numRows) bits |= sideways[(row+1)*wordsPerRow + word];
+            out[row*wordsPerRow + word] = bits;
+        }
+    }
+}
+
+
+/**
+ * @brief Counts the cells holding an infected in the 3x3 block around a cell, staying on the board.
+ * @param[in] row The row of the center cell.
+ * @param[in] col The column of the center cell.
+ * @return The number of infected cells, 0 to 9.
+ */
+int InfectionBitboard::countInfectedAround(int row, int col) const {
+    int count = 0;
+    for (int r=max(row-1, 0); r<=min(row+1, numRows-1); r++) {
+        for (int c=max(col-1, 0); c<=min(col+1, numCols-1); c++) {
+            count += testBit(infected, r, c);
+        }
+    }
+    return count;
+}
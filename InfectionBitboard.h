@@ -0,0 +1,72 @@
+/**
+ * @file InfectionBitboard.h
+ * @brief The InfectionBitboard class declaration file.
+ */
+
+#ifndef INFECTIONBITBOARD_H
+#define INFECTIONBITBOARD_H
+
+#include <stdint.h>
+#include <vector>
+
+using namespace std;
+
+/**
+ * @class InfectionBitboard
+ * @brief One bit per board cell for where the infected, healthy humans, and doctors stand, packed 64 cells to a word, row by row.
+ * spread() finds every cell next to an infected and every cell next to a doctor with shifts and ORs over whole words,
+ * so a time unit's infections and heals take a few instructions per 64 cells however crowded the board is.
+ * "Next to" is the 3x3 block around a cell, as in Board::isNextTo().
+ */
+class InfectionBitboard {
+    public:
+    InfectionBitboard(int numRows, int numCols);
+
+    //Clear every plane.
+    void clear();
+
+    //Mark a cell as holding an infected human, a healthy regular human, or a doctor.
+    void addInfected(int row, int col) { setBit(infected, row, col); }
+    void addHealthy(int row, int col) { setBit(healthy, row, col); }
+    void addDoctor(int row, int col) { setBit(doctors, row, col); }
+
+    //Work out which cells get infected and which get healed this time unit.
+    void spread();
+
+    //After spread(): whether the healthy humans on a cell become infected (next to an infected, and not next to a doctor),
+    //and whether the infected on a cell are healed (next to a doctor).
+    bool infects(int row, int col) const { return testBit(newInfections, row, col); }
+    bool heals(int row, int col) const { return testBit(newHeals, row, col); }
+
+    //Number of cells holding an infected in the 3x3 block around (row, col).
+    int countInfectedAround(int row, int col) const;
+
+
+    protected:
+    //Spread every set bit of "plane" to the 3x3 block around it, into "out".
+    void dilate(const vector<uint64_t>& plane, vector<uint64_t>& out);
+
+    void setBit(vector<uint64_t>& plane, int row, int col) { plane[row*wordsPerRow + col/64] |= uint64_t(1) << (col%64); }
+    bool testBit(const vector<uint64_t>& plane, int row, int col) const { return (plane[row*wordsPerRow + col/64] >> (col%64)) & 1; }
+
+    //Board dimensions, and the words holding each row.
+    int numRows;
+    int numCols;
+    int wordsPerRow;
+
+    //Where everyone stands.
+    vector<uint64_t> infected;
+    vector<uint64_t> healthy;
+    vector<uint64_t> doctors;
+
+    //Results of spread().
+    vector<uint64_t> newInfections;
+    vector<uint64_t> newHeals;
+
+    //Scratch planes for spread(): cells next to an infected, cells next to a doctor, and every row dilated sideways only.
+    vector<uint64_t> nearInfected;
+    vector<uint64_t> nearDoctor;
+    vector<uint64_t> sideways;
+};
+
+#endif // INFECTIONBITBOARD_H
@@ -0,0 +1,80 @@
+/**
+ * @file NeighborGrid.cpp
+ * @brief The NeighborGrid class implementation file.
+ */
+
+#include <algorithm>
+
+#include "NeighborGrid.h"
+
+using namespace std;
+
+/**
+ * @brief The NeighborGrid class constructor.
+ * Allocates one list head per board cell, all initially empty.
+ *
+ * @param rows The number of rows in the board.
+ * @param cols The number of columns in the board.
+ */
+NeighborGrid::NeighborGrid(int rows, int cols) {
+    numRows = rows;
+    numCols = cols;
+    cellHead.assign(numRows*numCols, -1);
+}
+
+
+/**
+ * @brief Empties the grid.
+ * Only the cells used by the previous build are cleared, so the cost is proportional to the number of agents rather than the board area.
+ * @param[in] count The number of agents about to be inserted.
+ */
+void NeighborGrid::reset(int count) {
+    for (size_t i=0; i<agentCell.size(); i++) {
+        cellHead[agentCell[i]] = -1;
+    }
+    agentCell.assign(count, 0);
+    nextInCell.assign(count, -1);
+}
+
+
+/**
+ * @brief Places an agent in the bucket for its cell.
+ * Agents are pushed on the front of the list, so inserting them from the highest id down keeps every list in ascending order.
+ * @param[in] id The agent's id (its index in the "humans" array).
+ * @param[in] row The agent's row.
+ * @param[in] col The agent's column.
+ */
+void NeighborGrid::insert(int id, int row, int col) {
+    int cell = row*numCols + col;
+    agentCell[id] = cell;
+    nextInCell[id] = cellHead[cell];
+    cellHead[cell] = id;
+}
+
+
+/**
+ * @brief Finds the agents adjacent to a cell (horizontally, vertically, diagonally, or on the same cell).
+ * Only ids greater than "minId" are returned, so each adjacent pair is reported exactly once when called for every agent.
+ * @param[in] row The row at the center of the 3x3 block.
+ * @param[in] col The column at the center of the 3x3 block.
+ * @param[in] minId Ids less than or equal to this value are skipped.
+ * @param[out] neighbors Filled with the matching ids in ascending order.
+ */
+void NeighborGrid::gatherNeighbors(int row, int col, int minId, vector<int>& neighbors) {
+    neighbors.clear();
+
+    for (int r=row-1; r<=row+1; r++) {
+        if (r<0 || r>=numRows) continue;
+        for (int c=col-1; c<=col+1; c++) {
+            if (c<0 || c>=numCols) continue;
+            for (int id=cellHead[r*numCols + c]; id!=-1; id=nextInCell[id]) {
+                if (id > minId) {
+                    neighbors.push_back(id);
+                }
+            }
+        }
+    }
+
+    //Merge the 9 lists into a single ascending order.
+    sort(neighbors.begin(), neighbors.end());
+}
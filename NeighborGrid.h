@@ -0,0 +1,47 @@
+/**
+ * @file NeighborGrid.h
+ * @brief The NeighborGrid class declaration file.
+ */
+
+#ifndef NEIGHBORGRID_H
+#define NEIGHBORGRID_H
+
+#include <vector>
+
+using namespace std;
+
+/**
+ * @class NeighborGrid
+ * @brief Buckets agents by board cell so that neighbor queries only visit the 3x3 block around a cell.
+ * Each cell holds a singly linked list of agent ids (stored in plain arrays), kept in ascending id order.
+ */
+class NeighborGrid {
+    public:
+    NeighborGrid(int numRows, int numCols);
+
+    //Empty the grid and get ready to bucket "count" agents.
+    void reset(int count);
+
+    //Bucket one agent. Agents must be inserted from the highest id down.
+    void insert(int id, int row, int col);
+
+    //Collect, in ascending order, the ids above "minId" that are within 1 cell of (row, col).
+    void gatherNeighbors(int row, int col, int minId, vector<int>& neighbors);
+
+
+    protected:
+    //Board dimensions.
+    int numRows;
+    int numCols;
+
+    //First agent id in each cell, or -1 if the cell is empty.
+    vector<int> cellHead;
+
+    //Next agent id in the same cell, or -1 at the end of the list. Indexed by agent id.
+    vector<int> nextInCell;
+
+    //Cell each agent was bucketed into, used to clear only the cells that were touched.
+    vector<int> agentCell;
+};
+
+#endif // NEIGHBORGRID_H
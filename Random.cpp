@@ -0,0 +1,165 @@
+/**
+ * @file Random.cpp
+ * @brief The Random class implementation file.
+ *
+ * Uses the xoshiro256** generator and splitmix64 seeding by David Blackman and Sebastiano Vigna.
+ *     Reference: http://prng.di.unimi.it/
+ */
+
+#include "Random.h"
+
+using namespace std;
+
+/**
+ * @brief Rotates a 64-bit value left by k bits.
+ */
+static inline uint64_t rotl(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+
+/**
+ * @brief The Random class constructor.
+ * Seeds the generator with 0.
+ */
+Random::Random() {
+    seed(0);
+}
+
+
+/**
+ * @brief The Random class constructor.
+ * @param initSeed The seed. Generators given the same seed produce the same numbers.
+ */
+Random::Random(uint64_t initSeed) {
+    seed(initSeed);
+}
+
+
+/**
+ * @brief Resets the state from a 64-bit seed.
+ * The seed is expanded into the four state words with splitmix64, which never yields an all-zero state.
+ * @param[in] initSeed The seed.
+ */
+void Random::seed(uint64_t initSeed) {
+    uint64_t x = initSeed;
+    for (int i=0; i<4; i++) {
+        uint64_t z = (x += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        state[i] = z ^ (z >> 31);
+    }
+}
+
+
+/**
+ * @brief Advances the generator.
+ * @return The next 64 random bits.
+ */
+uint64_t Random::next() {
+    uint64_t result = rotl(state[1] * 5, 7) * 9;
+    uint64_t t = state[1] << 17;
+
+    state[2] ^= state[0];
+    state[3] ^= state[1];
+    state[1] ^= state[2];
+    state[0] ^= state[3];
+    state[2] ^= t;
+    state[3] = rotl(state[3], 45);
+
+    return result;
+}
+
+
+/**
+ * @brief Advances the generator.
+ * @return A random number in the range [0, 2^31-1] (the top 31 bits of next()).
+ */
+int Random::nextInt() {
+    return int(next() >> 33);
+}
+
+
+/**
+ * @brief Splits off an independent stream.
+ * Returns a copy of this generator, then jumps this generator 2^128 draws ahead,
+ * so the returned stream and every later split never overlap.
+ * @return A generator for the new stream.
+ */
+Random Random::split() {
+    Random stream = *this;
+    jump();
+    return stream;
+}
+
+
+/**
+ * @brief Moves the generator 2^128 draws ahead.
+ */
+void Random::jump() {
+    static const uint64_t JUMP[] = { 0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL, 0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL };
+
+    uint64_t s[4] = { 0, 0, 0, 0 };
+    for (int i=0; i<4; i++) {
+        for (int b=0; b<64; b++) {
+            if (JUMP[i] & (1ULL << b)) {
+                for (int w=0; w<4; w++) {
+                    s[w] ^= state[w];
+                }
+            }
+            next();
+        }
+    }
+
+    for (int w=0; w<4; w++) {
+        state[w] = s[w];
+    }
+}
+
+
+/**
+ * @brief Writes the generator state as 32 bytes (four little-endian 64-bit words).
+ * @param[out] out The binary stream to write to.
+ */
+void Random::save(ostream& out) const {
+    unsigned char bytes[32];
+    for (int w=0; w<4; w++) {
+        for (int b=0; b<8; b++) {
+            bytes[w*8 + b] = (unsigned char)(state[w] >> (8*b));
+        }
+    }
+    out.write((const char*)bytes, sizeof(bytes));
+}
+
+
+/**
+ * @brief Reads a generator state written by save().
+ * The generator continues exactly where the saved one left off.
+ * @param[in] in The binary stream to read from.
+ */
+void Random::load(istream& in) {
+    unsigned char bytes[32];
+    in.read((char*)bytes, sizeof(bytes));
+    for (int w=0; w<4; w++) {
+        state[w] = 0;
+        for (int b=0; b<8; b++) {
+            state[w] |= uint64_t(bytes[w*8 + b]) << (8*b);
+        }
+    }
+}
+
+
+/**
+ * @brief Mixes a key and a counter into 64 random-looking bits (the splitmix64 finalizer).
+ * Different counters under one key always give different results, so hash(key, id) can seed an independent stream per agent
+ * without any shared state.
+ * @param[in] key The key, e.g. a value drawn once per time unit.
+ * @param[in] counter The counter, e.g. an agent id.
+ * @return The mixed bits.
+ */
+uint64_t Random::hash(uint64_t key, uint64_t counter) {
+    uint64_t z = key + (counter+1) * 0x9e3779b97f4a7c15ULL;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
@@ -0,0 +1,53 @@
+/**
+ * @file Random.h
+ * @brief The Random class declaration file.
+ */
+
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <stdint.h>
+#include <iostream>
+
+using namespace std;
+
+/**
+ * @class Random
+ * @brief A small, fast, seedable random number generator (xoshiro256**).
+ * Each Board owns one, so boards never share random state.
+ * A generator can be split into independent, non-overlapping streams, and its state can be saved and restored exactly.
+ */
+class Random {
+    public:
+    Random();
+    Random(uint64_t seed);
+
+    //Reset the state from a single 64-bit seed.
+    void seed(uint64_t seed);
+
+    //Next 64 random bits.
+    uint64_t next();
+
+    //Next random number in the range [0, 2^31-1], the same range as rand().
+    int nextInt();
+
+    //Hand out the current stream and move this generator 2^128 draws ahead.
+    Random split();
+
+    //Save or restore the exact state.
+    void save(ostream& out) const;
+    void load(istream& in);
+
+    //Well-mixed 64 bits that depend only on a key and a counter. Used to seed per-agent streams.
+    static uint64_t hash(uint64_t key, uint64_t counter);
+
+
+    protected:
+    //Move 2^128 draws ahead.
+    void jump();
+
+    //Generator state. Never all zero.
+    uint64_t state[4];
+};
+
+#endif // RANDOM_H
@@ -10,298 +10,185 @@
 #include <cstdlib>
 #include <iostream>
 #include <string>
-//Needed for distance formula ( sqrt(), pow() )
-#include <cmath>
 
 #include "Human.h"
-#include "conio.h"
 #include "Scavenger.h"
 
 using namespace std;
 
 /**
  * @brief The Scavenger class constructor.
- * This function initializes the row, col, infected, and board variables.
- * As well as the object type ("Scavenger") and various progress booleans:
- * hasReachedGate, hasFirstIngredient, hasSecondIngredient, hasReachedResearchFacility.
+ * This function initializes the id, agents, and board variables.
+ * It leaves the agent's entries in the AgentStore alone: the board gives a new scavenger its progress and health
+ * (see Board::addAgent() and Board::changeRole()), so viewing an existing scavenger never resets it.
  *
- * @param initRow the initial scavenger row location.
- * @param initCol the initial scavenger column location.
- * @param initInfected whether the scavenger is initially infected.
+ * @param agentId the id of this scavenger's agent in the board's AgentStore.
  * @param theBoard a pointer to the board (used to ask board whether a proposed move is ok).
  */
-Scavenger::Scavenger(int initRow, int initCol, bool initInfected, Board* theBoard) : Human(initRow, initCol, initInfected, theBoard) {
-
-    //Intialize string of object type.
-    objectType = "Scavenger";
-
-    //Initialize boolean progress variables (in terms of the goal points).
-    hasReachedGate = false;
-    hasFirstIngredient = false;
-    hasSecondIngredient = false;
-    hasReachedResearchFacility = false;
-}
-
-/**
- * @brief The Scavenger class destructor.
- */
-Scavenger::~Scavenger() {
-    // Nothing to do
+Scavenger::Scavenger(int agentId, Board* theBoard) : Human(agentId, theBoard) {
 }
 
 /**
- * @brief Have the scavenger try to move.
- * Based on various progress booleans, have the scavenger pathfind to a specified goal point.
- * Uses the "doPathFindingMove(goalRow, goalCol)" method.
+ * @brief Have the scavenger choose where to try to move.
+ * Based on its progress and on which ingredients are still on the map, have the scavenger pathfind to a specified goal point.
+ * Uses the "doPathFindingMove(dice, goal, row, col)" method.
  * To know whether it is ok to move to some position (r,c), ask the board
  * whether the position is ok. E.g., "if( board->tryMove(r,c) ) ..."
- * If the move is ok, then update the scavenger's row and column to reflect the move.
+ * Nothing is changed here; the board moves the scavenger to the chosen location afterwards.
+ * @param[in,out] dice Random numbers for the move.
+ * @param[out] row The row to move to (the current row if the scavenger stays).
+ * @param[out] col The column to move to (the current column if the scavenger stays).
  */
-void Scavenger::move() {
-    //Pathfind to gate.
-    if (! hasReachedGate) {
-        doPathFindingMove(gateRow, gateCol);
-    }
-
-    //Pathfind to first ingredient.
-    else if (! hasFirstIngredient) {
-        doPathFindingMove(firstIngredientRow, firstIngredientCol);
-    }
-
-    //Pathfind to second ingredient.
-    else if (! hasSecondIngredient) {
-        doPathFindingMove(secondIngredientRow, secondIngredientCol);
-    }
-
-    //Pathfind to research facility.
-    else if (! hasReachedResearchFacility) {
-        doPathFindingMove(researchFacilityRow, researchFacilityCol);
-    }
+void Scavenger::proposeMove(Random& dice, int& row, int& col) {
+    unsigned char progress = agents->progress[id];
+    ScavengerGoal goal;
+    getLocation(row, col);
 
     //If reached research facility, then the scavenger is done.
-    else if (hasReachedResearchFacility) {
+    if (progress & REACHED_RESEARCH_FACILITY) {
         //Don't move.
     }
 
-    //None of the other moves worked, do a random move.
+    //Pathfind to the goal point the board says is next: the gate, an ingredient nobody has taken yet, or the research facility.
+    else if (board->chooseScavengerGoal(id, goal)) {
+        doPathFindingMove(dice, goal, row, col);
+    }
+
+    //Other scavengers took the ingredients, do a random move.
     else {
         int rowDelta, colDelta;
 
         //Generate a +/- 2 row and column delta.
-        rowDelta=rand()%5-2;
-        colDelta=rand()%5-2;
+        rowDelta=dice.nextInt()%5-2;
+        colDelta=dice.nextInt()%5-2;
 
         //Ask the board whether the move is valid.
         if(board->tryMove(row+rowDelta, col+colDelta)) {
-            row+=rowDelta;
-            col+=colDelta;
+            row += rowDelta;
+            col += colDelta;
         }
     }
 }
 
 
 /**
- * @brief Draws the Scavenger.
- * Draws the Scavenger at the current row/col location on the screen.
- * Draws the scavenger yellow and marks the scavenger with an 'S'.
- * Remember that the first conio row=1, and first conio col=1.
+ * @brief Chooses a move toward a goal point.
+ * Walks down the board's distance field for the goal: up to two steps, each onto the free neighboring cell that is fewest steps
+ * from the goal, so the scavenger goes around walls instead of into them. Every step is a lookup of at most 8 cells.
+ * If no step gets closer (the way is crowded, or the goal cannot be reached from here), do a random move instead.
+ * @param[in,out] dice Random numbers for the move.
+ * @param[in] goal The goal point to move toward.
+ * @param[in,out] row The row to move from, updated to the row to move to.
+ * @param[in,out] col The column to move from, updated to the column to move to.
  */
-void Scavenger::draw() {
-    cout << conio::gotoRowCol(row+1,col+1);
-    cout << conio::bgColor(conio::YELLOW);
-    cout << 'S' << conio::resetAll() << flush;
-}
-
-
-/**
- * @brief Sets the row and column of the first vaccine ingredient.
- * Used exclusively by the derived Scavenger class.
- * Used as a goal point to pathfind to, as well as track if the scavenger is touching this goal point.
- * @param[in] row The row of the first ingredient.
- * @param[in] col The column of the first ingredient.
- */
-void Scavenger::setFirstIngredientRowCol(int row, int col) {
-    firstIngredientRow = row;
-    firstIngredientCol = col;
-}
-
-
-/**
- * @brief Sets the row and column of the second vaccine ingredient.
- * Used exclusively by the derived Scavenger class.
- * Used as a goal point to pathfind to, as well as track if the scavenger is touching this goal point.
- * @param[in] row The row of the second ingredient.
- * @param[in] col The column of the second ingredient.
- */
-void Scavenger::setSecondIngredientRowCol(int row, int col) {
-    secondIngredientRow = row;
-    secondIngredientCol = col;
-}
-
-
-/**
- * @brief Sets the row and column of the middle of the city gate.
- * Used exclusively by the derived Scavenger class.
- * Used as a goal point to pathfind to, as well as track if the scavenger is touching this goal point.
- * @param[in] row The row of the city gate.
- * @param[in] col The column of the city gate.
- */
-void Scavenger::setGateRowCol(int row, int col) {
-    gateRow = row;
-    gateCol = col;
-}
-
-
-/**
- * @brief Sets the row and column of a point in the research facility.
- * Used exclusively by the derived Scavenger class.
- * Used as a goal point to pathfind to, as well as track if the scavenger is touching this goal point.
- * @param[in] row The row of the research facility.
- * @param[in] col The column of the research facility.
- */
-void Scavenger::setResearchFacilityRowCol(int row, int col) {
-    researchFacilityRow = row;
-    researchFacilityCol = col;
-}
-
-
-/**
- * @brief Moves the scavenger toward a goal point.
- * @param[in] goalRow The row of a goal point.
- * @param[in] goalCol The column of a goal point.
- */
-void Scavenger::doPathFindingMove(int goalRow, int goalCol) {
+void Scavenger::doPathFindingMove(Random& dice, ScavengerGoal goal, int& row, int& col) {
+    const DistanceField& field = board->getGoalField(goal);
     int rowDelta, colDelta;
+    int startRow = row;
+    int startCol = col;
+
+    //Take up to two steps downhill.
+    for (int step=0; step<2; step++) {
+        int bestDistance = field.at(row, col);
+        int bestRow = row;
+        int bestCol = col;
+
+        for (rowDelta=-1; rowDelta<=1; rowDelta++) {
+            for (colDelta=-1; colDelta<=1; colDelta++) {
+                int r = row+rowDelta;
+                int c = col+colDelta;
+                //Is the step allowed (which keeps it on the board) and closer?
+                if (canStepOnto(r, c, startRow, startCol) && field.at(r, c) < bestDistance) {
+                    bestDistance = field.at(r, c);
+                    bestRow = r;
+                    bestCol = c;
+                }
+            }
+        }
 
-    //Calculate current distance to goal point.
-    float oldDistanceToGoal = sqrt((pow(row-goalRow,2)) + (pow(col-goalCol,2)));
-
-    //Declare variable for storing calculation of new distance to goal point.
-    float newDistanceToGoal;
-
-
-    //Try left
-    rowDelta=0;
-    colDelta=(rand()%2)-2;
-    newDistanceToGoal = sqrt((pow((row+rowDelta)-goalRow,2)) + (pow((col+colDelta)-goalCol,2)));
-    
-        //Is move valid and effective?
-    if (board->tryMove(row+rowDelta, col+colDelta) && (newDistanceToGoal <= oldDistanceToGoal)) {
-        row+=rowDelta;
-        col+=colDelta;
-    }
-
-
-    //Try down
-    rowDelta=(rand()%2)+1;
-    colDelta=0;
-    newDistanceToGoal = sqrt((pow((row+rowDelta)-goalRow,2)) + (pow((col+colDelta)-goalCol,2)));
-
-        //Is move valid and effective?
-    if (board->tryMove(row+rowDelta, col+colDelta) && (newDistanceToGoal <= oldDistanceToGoal)) {
-        row+=rowDelta;
-        col+=colDelta;
-        return;
-    }
-
-    //Try up
-    rowDelta=(rand()%2)-2;
-    colDelta=0;
-    newDistanceToGoal = sqrt((pow((row+rowDelta)-goalRow,2)) + (pow((col+colDelta)-goalCol,2)));
-
-        //Is move valid and effective?
-    if (board->tryMove(row+rowDelta, col+colDelta) && (newDistanceToGoal <= oldDistanceToGoal)) {
-        row+=rowDelta;
-        col+=colDelta;
-        return;
+        if (bestRow == row && bestCol == col) break;
+        row = bestRow;
+        col = bestCol;
     }
 
-    //Try right
-    rowDelta=0;
-    colDelta=(rand()%2)+1;
-    newDistanceToGoal = sqrt((pow((row+rowDelta)-goalRow,2)) + (pow((col+colDelta)-goalCol,2)));
-
-        //Is move valid and effective?
-    if (board->tryMove(row+rowDelta, col+colDelta) && (newDistanceToGoal <= oldDistanceToGoal)) {
-        row+=rowDelta;
-        col+=colDelta;
-        return;
-    }
+    if (row != startRow || col != startCol) return;
 
     //If none of those worked, do a random move.
-    rowDelta=rand()%5-2;
-    colDelta=rand()%5-2;
+    rowDelta=dice.nextInt()%5-2;
+    colDelta=dice.nextInt()%5-2;
 
     //Ask the board if move is allowed.
-    if(board->tryMove(row+rowDelta, col+colDelta)) {
-        row+=rowDelta;
-        col+=colDelta;
+    if(canStepOnto(row+rowDelta, col+colDelta, startRow, startCol)) {
+        row += rowDelta;
+        col += colDelta;
     }
 }
 
 
 /**
- * @brief Setter for the Scavenger boolean "hasReachedGate".
+ * @brief Setter for the Scavenger REACHED_GATE progress bit.
  * Sets the value to the value of "boolean".
- * @param[in] boolean The value to be assigned to "hasReachedGate".
+ * @param[in] boolean The value to be assigned to the REACHED_GATE bit.
  */
 void Scavenger::setHasReachedGate(bool boolean) {
-    hasReachedGate = boolean;
+    setProgress(REACHED_GATE, boolean);
 }
 
 
 /**
- * @brief Setter for the Scavenger boolean "hasFirstIngredient".
+ * @brief Setter for the Scavenger HAS_FIRST_INGREDIENT progress bit.
  * Sets the value to the value of "boolean".
- * @param[in] boolean The value to be assigned to "hasFirstIngredient".
+ * @param[in] boolean The value to be assigned to the HAS_FIRST_INGREDIENT bit.
  */
 void Scavenger::setHasFirstIngredient(bool boolean) {
-    hasFirstIngredient = boolean;
+    setProgress(HAS_FIRST_INGREDIENT, boolean);
 }
 
 
 /**
- * @brief Setter for the Scavenger boolean "hasSecondIngredient".
+ * @brief Setter for the Scavenger HAS_SECOND_INGREDIENT progress bit.
  * Sets the value to the value of "boolean".
- * @param[in] boolean The value to be assigned to "hasSecondIngredient".
+ * @param[in] boolean The value to be assigned to the HAS_SECOND_INGREDIENT bit.
  */
 void Scavenger::setHasSecondIngredient(bool boolean) {
-    hasSecondIngredient = boolean;
+    setProgress(HAS_SECOND_INGREDIENT, boolean);
 }
 
 
 /**
- * @brief Setter for the Scavenger boolean "hasReachedResearchFacility".
+ * @brief Setter for the Scavenger REACHED_RESEARCH_FACILITY progress bit.
  * Sets the value to the value of "boolean".
- * @param[in] boolean The value to be assigned to "hasReachedResearchFacility".
+ * @param[in] boolean The value to be assigned to the REACHED_RESEARCH_FACILITY bit.
  */
 void Scavenger::setHasReachedResearchFacility(bool boolean) {
-    hasReachedResearchFacility = boolean;
+    setProgress(REACHED_RESEARCH_FACILITY, boolean);
 }
 
 
 /**
- * @brief Getter for the Scavenger boolean "hasFirstIngredient".
- * @return The boolean value of "hasFirstIngredient".
+ * @brief Tells whether the scavenger may step onto a location during the move it is choosing.
+ * The cell the move started from counts as open, because the scavenger will already have stepped off it.
+ * @param[in] row The row to step onto.
+ * @param[in] col The column to step onto.
+ * @param[in] startRow The row the move started from.
+ * @param[in] startCol The column the move started from.
+ * @return Whether the step is allowed.
  */
-bool Scavenger::getHasFirstIngredient() {
-    return hasFirstIngredient;
+bool Scavenger::canStepOnto(int row, int col, int startRow, int startCol) {
+    return (row == startRow && col == startCol) || board->tryMove(row, col);
 }
 
 
 /**
- * @brief Getter for the Scavenger boolean "hasSecondIngredient".
- * @return The boolean value of "hasSecondIngredient".
+ * @brief Sets or clears one ScavengerProgress bit of this scavenger's agent in the AgentStore.
+ * @param[in] bit The ScavengerProgress bit to change.
+ * @param[in] boolean Whether the bit should be set.
  */
-bool Scavenger::getHasSecondIngredient() {
-    return hasSecondIngredient;
-}
-
-
-/**
- * @brief Getter for the Scavenger boolean "hasReachedResearchFacility".
- * @return The boolean value of "hasReachedResearchFacility".
- */
-bool Scavenger::getHasReachedResearchFacility() {
-    return hasReachedResearchFacility;
+void Scavenger::setProgress(unsigned char bit, bool boolean) {
+    if (boolean) {
+        agents->progress[id] |= bit;
+    }
+    else {
+        agents->progress[id] &= ~bit;
+    }
 }
@@ -18,56 +18,33 @@ using namespace std;
 /**
  * @class Scavenger
  * @brief The Scavenger class declaration.
+ * Unlike regular humans and doctors, every scavenger keeps its view for as long as it is one, in the board's "scavengers" batch.
  */
 class Scavenger : public Human {
     public:
-    Scavenger(int initRow, int initCol, bool initInfected, Board* thisBoard);
-	virtual ~Scavenger();
+    Scavenger(int agentId, Board* thisBoard);
 
-    //Redefine how a scavenger moves and is displayed
-	void move();
-	void draw();
+    //Redefine how a scavenger moves. Hides Human::proposeMove(); the board calls this one for every agent in its scavenger batch.
+	void proposeMove(Random& dice, int& row, int& col);
 
-	//Setters and getters
+	//Setters
 
-        //There are 4 goal points that need coordinates:
-        //City gate, 1st ingredient, 2nd ingredient, research facility.
-    void setFirstIngredientRowCol(int row, int col);
-    void setSecondIngredientRowCol(int row, int col);
-    void setGateRowCol(int row, int col);
-    void setResearchFacilityRowCol(int row, int col);
-
-        //Set if scavenger has reached those goal points.
+        //Set if scavenger has reached the goal points.
     void setHasReachedGate(bool boolean);
     void setHasFirstIngredient(bool boolean);
     void setHasSecondIngredient(bool boolean);
     void setHasReachedResearchFacility(bool boolean);
 
-        //Get if scavenger has reached those goal points.
-    bool getHasFirstIngredient();
-    bool getHasSecondIngredient();
-    bool getHasReachedResearchFacility();
-
-    //Path-finding function to reach those goals. Used by move().
-    void doPathFindingMove(int goalRow, int goalCol);
+    //Path-finding function to reach those goals. Used by proposeMove().
+    void doPathFindingMove(Random& dice, ScavengerGoal goal, int& row, int& col);
 
 
     protected:
-    //Booleans to track if scavenger has reached goal points.
-    bool hasReachedGate;
-    bool hasFirstIngredient;
-    bool hasSecondIngredient;
-    bool hasReachedResearchFacility;
+    //Whether a step of the move being chosen may land on (row, col).
+    bool canStepOnto(int row, int col, int startRow, int startCol);
 
-    //Coordinates of goal points.
-    int firstIngredientRow;
-    int firstIngredientCol;
-    int secondIngredientRow;
-    int secondIngredientCol;
-    int gateRow;
-    int gateCol;
-    int researchFacilityRow;
-    int researchFacilityCol;
+    //Sets or clears one of the ScavengerProgress bits in the AgentStore.
+    void setProgress(unsigned char bit, bool boolean);
 };
 
 #endif // SCAVENGER_H
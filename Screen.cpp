@@ -0,0 +1,184 @@
+/**
+ * @file Screen.cpp
+ * @brief The Screen class implementation file.
+ */
+
+#include <string>
+#include <unistd.h>
+#include <errno.h>
+
+#include "Screen.h"
+#include "conio.h"
+
+using namespace std;
+
+//A cell showing nothing: a space in the default colors.
+static const ScreenCell BLANK = { ' ', conio::RESET, conio::RESET };
+
+//Most bytes one cell can take in a frame: cursor move, reset, text and background colors, and the glyph.
+static const int MAX_BYTES_PER_CELL = 32;
+
+
+/**
+ * @brief Writes all of a buffer to standard output, retrying after partial writes and interruptions.
+ * @param[in] data The bytes to write.
+ * @param[in] length The number of bytes.
+ */
+static void writeAll(const char* data, size_t length) {
+    while (length > 0) {
+        ssize_t written = write(STDOUT_FILENO, data, length);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        data += written;
+        length -= written;
+    }
+}
+
+
+/**
+ * @brief The Screen class constructor.
+ * The screen starts out empty; call resize() before drawing.
+ */
+Screen::Screen() {
+    numRows = 0;
+    numCols = 0;
+    needsClear = true;
+}
+
+
+/**
+ * @brief Sets the size of the screen.
+ * Both buffers become blank and the terminal is cleared on the next present().
+ * Also reserves enough output space for a frame in which every cell changes.
+ * @param[in] rows The number of rows.
+ * @param[in] cols The number of columns.
+ */
+void Screen::resize(int rows, int cols) {
+    numRows = rows;
+    numCols = cols;
+    front.assign(numRows*numCols, BLANK);
+    back.assign(numRows*numCols, BLANK);
+    needsClear = true;
+    output.reserve(numRows*numCols*MAX_BYTES_PER_CELL + MAX_BYTES_PER_CELL);
+}
+
+
+/**
+ * @brief Blanks the back buffer so a new frame can be drawn.
+ */
+void Screen::clear() {
+    for (size_t i=0; i<back.size(); i++) {
+        back[i] = BLANK;
+    }
+}
+
+
+/**
+ * @brief Draws one character into the back buffer.
+ * @param[in] row The row (0-based).
+ * @param[in] col The column (0-based).
+ * @param[in] glyph The character to show.
+ * @param[in] fg The text color (conio::RESET for the default).
+ * @param[in] bg The background color (conio::RESET for the default).
+ */
+void Screen::put(int row, int col, char glyph, conio::Color fg, conio::Color bg) {
+    if (row<0 || row>=numRows || col<0 || col>=numCols) return;
+
+    ScreenCell& cell = back[row*numCols + col];
+    cell.glyph = glyph;
+    cell.fg = fg;
+    cell.bg = bg;
+}
+
+
+/**
+ * @brief Draws a line of text into the back buffer, one cell per character.
+ * @param[in] row The row (0-based).
+ * @param[in] col The column of the first character (0-based).
+ * @param[in] text The text to show.
+ * @param[in] fg The text color (conio::RESET for the default).
+ * @param[in] bg The background color (conio::RESET for the default).
+ */
+void Screen::putText(int row, int col, const string& text, conio::Color fg, conio::Color bg) {
+    for (size_t i=0; i<text.size(); i++) {
+        put(row, col+int(i), text[i], fg, bg);
+    }
+}
+
+
+/**
+ * @brief Sends the new frame to the terminal.
+ * Walks the buffers in row-major order and writes only the cells whose glyph or colors changed.
+ * The cursor is only repositioned when the next changed cell is not where the cursor already is,
+ * and colors are only re-sent when they differ from the previous written cell.
+ * Afterwards the back buffer becomes the front buffer and the cursor is parked below the screen.
+ * The frame is composed in "output" with conio's allocation-free sequences and sent with a single write() (no flushes per cell).
+ * Remember that the first conio row=1, and the first conio col=1.
+ */
+void Screen::present() {
+    output.clear();
+
+    if (needsClear) {
+        output += conio::CLEAR_SCREEN;
+        needsClear = false;
+    }
+
+    int cursorRow = -1, cursorCol = -1;
+    int currentFg = -1, currentBg = -1;
+    char rowCol[conio::MAX_ROW_COL_LENGTH];
+
+    for (int row=0; row<numRows; row++) {
+        for (int col=0; col<numCols; col++) {
+            int pos = row*numCols + col;
+            if (back[pos] == front[pos]) continue;
+
+            const ScreenCell& cell = back[pos];
+
+            //Move the cursor, unless it is already here from the previous write.
+            if (row != cursorRow || col != cursorCol) {
+                output.append(rowCol, conio::writeRowCol(rowCol, row+1, col+1));
+            }
+
+            //Change colors, if different from the previous write.
+            if (cell.fg != currentFg || cell.bg != currentBg) {
+                output += conio::RESET_ALL;
+                if (cell.fg != conio::RESET) output += conio::fgColorSequence(conio::Color(cell.fg));
+                if (cell.bg != conio::RESET) output += conio::bgColorSequence(conio::Color(cell.bg));
+                currentFg = cell.fg;
+                currentBg = cell.bg;
+            }
+
+            output += cell.glyph;
+            front[pos] = cell;
+            cursorRow = row;
+            cursorCol = col+1;
+        }
+    }
+
+    //Make sure colors are back to normal and the cursor is out of the way.
+    output += conio::RESET_ALL;
+    output.append(rowCol, conio::writeRowCol(rowCol, numRows+1, 1));
+
+    writeAll(output.data(), output.size());
+}
+
+
+/**
+ * @brief Exchanges the back buffer with another frame.
+ * Used to hand a drawn frame to another thread, or to take one from it, without copying cells.
+ * @param[in,out] frame A frame with the same number of cells as this screen.
+ */
+void Screen::swapBack(vector<ScreenCell>& frame) {
+    back.swap(frame);
+}
+
+
+/**
+ * @brief Gives the number of cells in a frame.
+ * @return Rows times columns.
+ */
+int Screen::size() const {
+    return numRows*numCols;
+}
@@ -0,0 +1,80 @@
+/**
+ * @file Screen.h
+ * @brief The Screen class declaration file.
+ */
+
+#ifndef SCREEN_H
+#define SCREEN_H
+
+#include <string>
+#include <vector>
+
+#include "conio.h"
+
+using namespace std;
+
+/**
+ * @brief What one character cell of the terminal shows.
+ */
+struct ScreenCell {
+    char glyph;             // Character shown
+    unsigned char fg;       // conio::Color of the text (conio::RESET for the default)
+    unsigned char bg;       // conio::Color of the background (conio::RESET for the default)
+
+    bool operator==(const ScreenCell& other) const {
+        return glyph == other.glyph && fg == other.fg && bg == other.bg;
+    }
+    bool operator!=(const ScreenCell& other) const {
+        return !(*this == other);
+    }
+};
+
+/**
+ * @class Screen
+ * @brief A double-buffered model of the terminal.
+ * Each frame is drawn into the back buffer. present() then sends escape sequences only for the cells
+ * that differ from what is already on the terminal (the front buffer), so the output per frame grows with
+ * the number of changed cells instead of the screen area.
+ * The whole frame is composed in one reusable buffer and reaches the terminal in a single write().
+ */
+class Screen {
+    public:
+    Screen();
+
+    //Set the size of the screen (0-based rows and columns) and start over with a blank terminal.
+    void resize(int numRows, int numCols);
+
+    //Blank the back buffer before drawing a new frame.
+    void clear();
+
+    //Draw into the back buffer. Anything outside the screen is ignored.
+    void put(int row, int col, char glyph, conio::Color fg, conio::Color bg);
+    void putText(int row, int col, const string& text, conio::Color fg, conio::Color bg);
+
+    //Send the changes since the last frame to the terminal.
+    void present();
+
+    //Exchange the back buffer with a frame of the same size, so frames can be handed between threads without copying.
+    void swapBack(vector<ScreenCell>& frame);
+
+    //Number of cells in a frame.
+    int size() const;
+
+
+    protected:
+    //Screen dimensions.
+    int numRows;
+    int numCols;
+
+    //What the terminal currently shows, and the frame being drawn. Both row-major.
+    vector<ScreenCell> front;
+    vector<ScreenCell> back;
+
+    //Whether the terminal still has to be cleared before the first frame.
+    bool needsClear;
+
+    //Bytes of the frame being sent. Reserved once by resize() and reused every frame.
+    string output;
+};
+
+#endif // SCREEN_H
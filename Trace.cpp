@@ -0,0 +1,427 @@
+/**
+ * @file Trace.cpp
+ * @brief The Trace class implementation file.
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+#include "Trace.h"
+#include "Varint.h"
+
+using namespace std;
+
+const char Trace::MAGIC[4] = {'I', 'S', 'T', 'R'};
+const char Trace::INDEX_MAGIC[4] = {'I', 'S', 'T', 'X'};
+
+//Largest event, in bytes: an event number followed by five more numbers.
+static const size_t MAX_EVENT_SIZE = 6*varint::MAX_LENGTH;
+
+
+/**
+ * @brief The Trace class constructor.
+ * A new trace records nothing until open() is called.
+ */
+Trace::Trace() {
+    recording = false;
+    used = 0;
+    bufferOffset = 0;
+    lastTime = -1;
+    lastMoveId = -1;
+    closing = false;
+    failed = false;
+}
+
+
+/**
+ * @brief The Trace class destructor.
+ * Closes the trace if it is still open, so nothing recorded is lost.
+ */
+Trace::~Trace() {
+    close();
+}
+
+
+/**
+ * @brief Starts recording to a file.
+ * The header and the starting state are written right away; events are written by the writer thread from then on.
+ * @param[in] path The trace file.
+ * @param[in] start The state the run starts from. Its "currentTime" is the time unit before the first recorded one.
+ * @return false if the file could not be created.
+ */
+bool Trace::open(const string& path, const Checkpoint& start) {
+    close();
+
+    file.open(path.c_str(), ios::binary | ios::trunc);
+    if (! file) return false;
+
+    file.write(MAGIC, sizeof(MAGIC));
+    varint::write(file, VERSION);
+    start.write(file);
+    if (! file) {
+        file.close();
+        return false;
+    }
+
+    buffer.resize(BUFFER_SIZE);
+    used = 0;
+    bufferOffset = file.tellp();
+    keyframeTimes.clear();
+    keyframeOffsets.clear();
+    lastTime = start.currentTime;
+    lastMoveId = -1;
+    closing = false;
+    failed = false;
+    recording = true;
+    writer = thread(&Trace::writeLoop, this);
+    return true;
+}
+
+
+/**
+ * @brief Stops recording.
+ * Writes the keyframe index, hands off the last partly filled buffer, waits for the writer thread to write everything, and closes the file.
+ * Does nothing if the trace is not open.
+ * @return false if any part of the trace could not be written.
+ */
+bool Trace::close() {
+    if (! recording) return true;
+
+    writeIndex();
+    handOff();
+    {
+        lock_guard<mutex> guard(lock);
+        closing = true;
+    }
+    bufferQueued.notify_one();
+    writer.join();
+
+    file.close();
+    recording = false;
+    return ! failed;
+}
+
+
+/**
+ * @brief Records that an agent moved.
+ * Payload: the gap in agent ids since the last move of the time unit, times FAR_STEP+1, plus the step.
+ * A step of at most MAX_STEP cells each way is packed as (rowDelta+MAX_STEP)*STEP_SPAN + (colDelta+MAX_STEP).
+ * Longer steps are stored as FAR_STEP, followed by the signed row and column deltas.
+ * Most moves take one or two bytes.
+ * @param[in] id The agent's id. Must be higher than that of the previous move in this time unit.
+ * @param[in] rowDelta How many rows the agent moved.
+ * @param[in] colDelta How many columns the agent moved.
+ */
+void Trace::move(int id, int rowDelta, int colDelta) {
+    reserve(MAX_EVENT_SIZE);
+
+    uint64_t gap = id - lastMoveId - 1;
+    lastMoveId = id;
+
+    if (abs(rowDelta) <= MAX_STEP && abs(colDelta) <= MAX_STEP) {
+        putEvent(TRACE_MOVE, gap*(FAR_STEP+1) + (rowDelta+MAX_STEP)*STEP_SPAN + (colDelta+MAX_STEP));
+    }
+    else {
+        putEvent(TRACE_MOVE, gap*(FAR_STEP+1) + FAR_STEP);
+        putNumber(varint::zigzag(rowDelta));
+        putNumber(varint::zigzag(colDelta));
+    }
+}
+
+
+/**
+ * @brief Records that an agent was infected. Payload: the agent id.
+ * @param[in] id The agent's id.
+ */
+void Trace::infect(int id) {
+    reserve(MAX_EVENT_SIZE);
+    putEvent(TRACE_INFECT, id);
+}
+
+
+/**
+ * @brief Records that an agent was healed. Payload: the agent id.
+ * @param[in] id The agent's id.
+ */
+void Trace::heal(int id) {
+    reserve(MAX_EVENT_SIZE);
+    putEvent(TRACE_HEAL, id);
+}
+
+
+/**
+ * @brief Records that the scavenger was hurt. Payload: the agent id.
+ * If this kills the scavenger, a TRACE_ROLE event and a TRACE_INFECT event follow.
+ * @param[in] id The scavenger's agent id.
+ */
+void Trace::hurt(int id) {
+    reserve(MAX_EVENT_SIZE);
+    putEvent(TRACE_HURT, id);
+}
+
+
+/**
+ * @brief Records that an agent changed role. Its scavenger progress is cleared too. Payload: the agent id times 4, plus the AgentRole.
+ * @param[in] id The agent's id.
+ * @param[in] newRole The agent's new role.
+ */
+void Trace::role(int id, AgentRole newRole) {
+    reserve(MAX_EVENT_SIZE);
+    putEvent(TRACE_ROLE, uint64_t(id)*4 + newRole);
+}
+
+
+/**
+ * @brief Records a scavenger's new progress. Payload: the agent id times 16, plus the ScavengerProgress bits.
+ * @param[in] id The scavenger's agent id.
+ * @param[in] bits The scavenger's progress bits after the change.
+ */
+void Trace::progress(int id, unsigned char bits) {
+    reserve(MAX_EVENT_SIZE);
+    putEvent(TRACE_PROGRESS, uint64_t(id)*16 + (bits & 15));
+}
+
+
+/**
+ * @brief Records that a landscape cell changed. Payload: the cell's row-major index, followed by one byte with the new marker.
+ * @param[in] cell The cell's index (row*numCols + col).
+ * @param[in] marker The cell's new landscape marker.
+ */
+void Trace::landscape(int cell, char marker) {
+    reserve(MAX_EVENT_SIZE);
+    putEvent(TRACE_LANDSCAPE, cell);
+    putByte(marker);
+}
+
+
+/**
+ * @brief Records that an agent was added. The new agent's id is the number of agents before it.
+ * Followed by the row, the column, and one byte holding the infection status in bit 0 and the AgentRole above it.
+ * @param[in] row The agent's row.
+ * @param[in] col The agent's column.
+ * @param[in] infected Whether the agent is infected.
+ * @param[in] agentRole The agent's role.
+ */
+void Trace::addAgent(int row, int col, bool infected, AgentRole agentRole) {
+    reserve(MAX_EVENT_SIZE);
+    putEvent(TRACE_OTHER, TRACE_ADD_AGENT);
+    putNumber(row);
+    putNumber(col);
+    putByte(char((infected ? 1 : 0) | (agentRole << 1)));
+}
+
+
+/**
+ * @brief Records that the vaccine was applied, curing every agent.
+ */
+void Trace::vaccineApplied() {
+    reserve(MAX_EVENT_SIZE);
+    putEvent(TRACE_OTHER, TRACE_VACCINE_APPLIED);
+}
+
+
+/**
+ * @brief Records that the infection was worsened, which makes every doctor a human.
+ * The doctors' TRACE_ROLE events and the TRACE_ADD_AGENT events of the new infected follow.
+ */
+void Trace::infectionWorsened() {
+    reserve(MAX_EVENT_SIZE);
+    putEvent(TRACE_OTHER, TRACE_INFECTION_WORSENED);
+}
+
+
+/**
+ * @brief Records the end of a time unit, with the statistics that are not carried by other events.
+ * Followed by the time unit, the number of infected, and the city wall health (all signed),
+ * the bits of the vaccine research progress, and the number of scavengers alive (signed).
+ * @param[in] time The time unit that is complete.
+ * @param[in] numInfected The board's count of infected.
+ * @param[in] cityWallHealth The city wall health.
+ * @param[in] vaccineResearchProgress The vaccine research progress.
+ * @param[in] scavengersAlive The number of scavengers alive.
+ */
+void Trace::endTick(int time, int numInfected, int cityWallHealth, float vaccineResearchProgress, int scavengersAlive) {
+    reserve(MAX_EVENT_SIZE);
+
+    uint32_t progressBits;
+    memcpy(&progressBits, &vaccineResearchProgress, sizeof(progressBits));
+
+    putEvent(TRACE_OTHER, TRACE_END_TICK);
+    putNumber(varint::zigzag(time));
+    putNumber(varint::zigzag(numInfected));
+    putNumber(varint::zigzag(cityWallHealth));
+    putNumber(progressBits);
+    putNumber(varint::zigzag(scavengersAlive));
+
+    lastTime = time;
+    lastMoveId = -1;
+}
+
+
+/**
+ * @brief Records a keyframe: the whole state at the end of the time unit just completed.
+ * Followed by the length of the encoded Checkpoint, then the Checkpoint itself (see Checkpoint::write()).
+ * The keyframe is encoded here and queued as a buffer of its own.
+ * @param[in] state The state. Its "currentTime" must be the time unit of the last TRACE_END_TICK.
+ */
+void Trace::keyframe(const Checkpoint& state) {
+    ostringstream encoded;
+    state.write(encoded);
+    string bytes = encoded.str();
+
+    reserve(MAX_EVENT_SIZE);
+    keyframeTimes.push_back(state.currentTime);
+    keyframeOffsets.push_back(bufferOffset + used);
+    putEvent(TRACE_OTHER, TRACE_KEYFRAME);
+    putNumber(bytes.size());
+    handOff();
+
+    vector<char> block(bytes.begin(), bytes.end());
+    queue(block);
+}
+
+
+/**
+ * @brief Ends the events with the keyframe index, followed by the trailer that lets a reader find it from the end of the file.
+ * The index event holds the last completed time unit and the number of keyframes,
+ * then the time unit (signed) and file offset of each keyframe, both as the difference from the one before.
+ */
+void Trace::writeIndex() {
+    reserve(MAX_EVENT_SIZE);
+    uint64_t indexOffset = bufferOffset + used;
+    putEvent(TRACE_OTHER, TRACE_INDEX);
+    putNumber(varint::zigzag(lastTime));
+    putNumber(keyframeTimes.size());
+
+    int previousTime = 0;
+    uint64_t previousOffset = 0;
+    for (size_t k=0; k<keyframeTimes.size(); k++) {
+        reserve(MAX_EVENT_SIZE);
+        putNumber(varint::zigzag(keyframeTimes[k] - previousTime));
+        putNumber(keyframeOffsets[k] - previousOffset);
+        previousTime = keyframeTimes[k];
+        previousOffset = keyframeOffsets[k];
+    }
+
+    reserve(INDEX_TRAILER_SIZE);
+    for (int b=0; b<8; b++) {
+        putByte(char(indexOffset >> (8*b)));
+    }
+    for (int b=0; b<4; b++) {
+        putByte(INDEX_MAGIC[b]);
+    }
+}
+
+
+/**
+ * @brief Appends an event number: the payload shifted above a TraceTag.
+ * @param[in] tag The kind of event.
+ * @param[in] payload The event's payload.
+ */
+void Trace::putEvent(TraceTag tag, uint64_t payload) {
+    putNumber((payload << TAG_BITS) | tag);
+}
+
+
+/**
+ * @brief Appends a variable-length number. The caller must have reserved room for it.
+ * @param[in] value The number.
+ */
+void Trace::putNumber(uint64_t value) {
+    used += varint::encode(value, &buffer[used]);
+}
+
+
+/**
+ * @brief Appends a byte. The caller must have reserved room for it.
+ * @param[in] byte The byte.
+ */
+void Trace::putByte(char byte) {
+    buffer[used++] = byte;
+}
+
+
+/**
+ * @brief Makes sure the buffer has room for "bytes" more bytes.
+ * @param[in] bytes The most bytes about to be appended.
+ */
+void Trace::reserve(size_t bytes) {
+    if (used + bytes > buffer.size()) {
+        handOff();
+    }
+}
+
+
+/**
+ * @brief Queues the filled part of the buffer for the writer thread and starts filling a spare one.
+ * Only waits if MAX_QUEUED buffers are already waiting, so memory stays bounded when the disk cannot keep up.
+ */
+void Trace::handOff() {
+    if (used == 0) return;
+
+    buffer.resize(used);
+    queue(buffer);
+
+    buffer.resize(BUFFER_SIZE);
+    used = 0;
+}
+
+
+/**
+ * @brief Queues bytes for the writer thread, to be written after everything queued before them.
+ * @param[in,out] bytes The bytes to write. Replaced with a spare buffer, if there is one.
+ */
+void Trace::queue(vector<char>& bytes) {
+    bufferOffset += bytes.size();
+    {
+        unique_lock<mutex> guard(lock);
+        while (queued.size() >= MAX_QUEUED && ! failed) {
+            bufferWritten.wait(guard);
+        }
+
+        queued.push_back(vector<char>());
+        queued.back().swap(bytes);
+
+        if (! spare.empty()) {
+            bytes.swap(spare.back());
+            spare.pop_back();
+        }
+    }
+    bufferQueued.notify_one();
+}
+
+
+/**
+ * @brief Writes queued buffers to the file in order, until close() is called and nothing is left.
+ * Written buffers are kept for reuse, so recording allocates nothing once a few buffers exist.
+ * If a write fails, the remaining buffers are dropped and close() reports the failure.
+ */
+void Trace::writeLoop() {
+    unique_lock<mutex> guard(lock);
+
+    while (true) {
+        while (queued.empty() && ! closing) {
+            bufferQueued.wait(guard);
+        }
+        if (queued.empty()) return;
+
+        vector<char> next;
+        next.swap(queued.front());
+        queued.pop_front();
+
+        //Write without holding the lock, so the simulation can keep queueing.
+        guard.unlock();
+        if (! failed) {
+            file.write(&next[0], next.size());
+        }
+        guard.lock();
+
+        if (! file) {
+            failed = true;
+        }
+        spare.push_back(vector<char>());
+        spare.back().swap(next);
+        bufferWritten.notify_one();
+    }
+}
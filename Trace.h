@@ -0,0 +1,169 @@
+/**
+ * @file Trace.h
+ * @brief The Trace class declaration file.
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "AgentStore.h"
+#include "Checkpoint.h"
+
+using namespace std;
+
+/**
+ * @brief Kinds of event in a trace. Stored in the low TAG_BITS bits of the first number of each event.
+ */
+enum TraceTag {
+    TRACE_MOVE,         // An agent moved
+    TRACE_INFECT,       // An agent was infected
+    TRACE_HEAL,         // An infected agent was healed by a doctor
+    TRACE_HURT,         // A scavenger lost 1/4 of its health
+    TRACE_ROLE,         // An agent changed role
+    TRACE_PROGRESS,     // A scavenger's ScavengerProgress bits changed
+    TRACE_LANDSCAPE,    // A landscape cell changed
+    TRACE_OTHER         // One of the TraceOther events
+};
+
+/**
+ * @brief Rarer events, stored in the payload of a TRACE_OTHER event.
+ */
+enum TraceOther {
+    TRACE_END_TICK,             // The time unit is complete
+    TRACE_ADD_AGENT,            // An agent was added
+    TRACE_VACCINE_APPLIED,      // applyVaccine() cured everyone
+    TRACE_INFECTION_WORSENED,   // makeInfectionWorse() turned every doctor into a human
+    TRACE_KEYFRAME,             // A Checkpoint of the whole state, for seeking
+    TRACE_INDEX                 // Where the keyframes are. Always the last event
+};
+
+/**
+ * @class Trace
+ * @brief Records what happens during a run to a compact binary file.
+ * A trace is a magic number and version, a Checkpoint of the state the run started from, and then a stream of events.
+ * Every event starts with one variable-length number holding a TraceTag in its low bits and a payload above them;
+ * see the event functions for what follows. Events after the TRACE_END_TICK of one time unit belong to the next.
+ * Keyframes holding the whole state follow the TRACE_END_TICK of some time units, so a TraceReader can seek
+ * without replaying from the start. A closed trace ends with a TRACE_INDEX event listing them, and a fixed-size trailer
+ * (INDEX_TRAILER_SIZE bytes: the index event's offset as 8 little-endian bytes, then INDEX_MAGIC).
+ *
+ * Events are encoded into an in-memory buffer on the simulation thread. Full buffers are handed to a writer thread,
+ * so the simulation never waits for the disk unless the disk falls far behind.
+ */
+class Trace {
+    public:
+    Trace();
+    ~Trace();
+
+    //Bumped whenever the format changes.
+    static const uint32_t VERSION = 1;
+
+    //First bytes of every trace file, and last bytes of a trace that was closed properly.
+    static const char MAGIC[4];
+    static const char INDEX_MAGIC[4];
+    static const int INDEX_TRAILER_SIZE = 12;
+
+    //Number of low bits of an event's first number that hold its TraceTag.
+    static const int TAG_BITS = 3;
+
+    //Moves of up to this many cells in each direction are packed with the agent id.
+    static const int MAX_STEP = 2;
+    static const int STEP_SPAN = 2*MAX_STEP+1;
+    static const int FAR_STEP = STEP_SPAN*STEP_SPAN;
+
+    //Create the file, write the header and the starting state, and start the writer thread.
+    bool open(const string& path, const Checkpoint& start);
+
+    //Write out everything recorded so far, stop the writer thread, and close the file. Returns false if anything failed to write.
+    bool close();
+
+    //Whether events are being recorded. Checked by the board before each event.
+    bool isOpen() const { return recording; }
+
+    //Events, in the order they happen.
+    void move(int id, int rowDelta, int colDelta);
+    void infect(int id);
+    void heal(int id);
+    void hurt(int id);
+    void role(int id, AgentRole newRole);
+    void progress(int id, unsigned char bits);
+    void landscape(int cell, char marker);
+    void addAgent(int row, int col, bool infected, AgentRole agentRole);
+    void vaccineApplied();
+    void infectionWorsened();
+    void endTick(int time, int numInfected, int cityWallHealth, float vaccineResearchProgress, int scavengersAlive);
+    void keyframe(const Checkpoint& state);
+
+
+    protected:
+    //Append one event number, or a plain number or byte.
+    void putEvent(TraceTag tag, uint64_t payload);
+    void putNumber(uint64_t value);
+    void putByte(char byte);
+
+    //Make sure an event of up to "bytes" bytes fits in the buffer, handing the buffer off first if it would not.
+    void reserve(size_t bytes);
+
+    //Give the filled part of "buffer" to the writer thread and continue in an empty buffer.
+    void handOff();
+
+    //Give "bytes" to the writer thread, leaving "bytes" with a spare buffer or empty.
+    void queue(vector<char>& bytes);
+
+    //Record where the keyframes are and end the file with the trailer that points at them.
+    void writeIndex();
+
+    //Body of the writer thread: write handed-off buffers until closed.
+    void writeLoop();
+
+    //Size of each buffer, and the most buffers that may wait for the writer thread before recording waits too.
+    static const size_t BUFFER_SIZE = 1 << 18;
+    static const size_t MAX_QUEUED = 8;
+
+    //Whether the trace is open.
+    bool recording;
+
+    //Buffer being filled, and how much of it is used.
+    vector<char> buffer;
+    size_t used;
+
+    //Offset in the file of the start of "buffer".
+    uint64_t bufferOffset;
+
+    //Time unit and file offset of each keyframe.
+    vector<int> keyframeTimes;
+    vector<uint64_t> keyframeOffsets;
+
+    //The last time unit that was completed.
+    int lastTime;
+
+    //Agent id of the last move in the current time unit. Moves come in ascending id order, so ids are stored as deltas.
+    int lastMoveId;
+
+    ofstream file;
+    thread writer;
+
+    //Guards everything below.
+    mutex lock;
+    condition_variable bufferQueued;
+    condition_variable bufferWritten;
+
+    //Buffers waiting for the writer thread, cut to the part that is used, and written buffers ready for reuse.
+    deque<vector<char> > queued;
+    vector<vector<char> > spare;
+
+    //Set by close() to let the writer thread finish, and by the writer thread if writing fails.
+    bool closing;
+    bool failed;
+};
+
+#endif // TRACE_H
@@ -0,0 +1,309 @@
+/**
+ * @file TraceReader.cpp
+ * @brief The TraceReader class implementation file.
+ */
+
+#include <cstring>
+
+#include "TraceReader.h"
+#include "Varint.h"
+
+using namespace std;
+
+
+/**
+ * @brief Reads a signed variable-length number into an int.
+ * @param[in] in The binary stream to read from.
+ * @param[out] value Where to put the number.
+ * @return false if the stream ended or failed.
+ */
+static bool readInt(istream& in, int& value) {
+    int64_t wide;
+    if (! varint::readSigned(in, wide)) return false;
+    value = int(wide);
+    return true;
+}
+
+
+/**
+ * @brief The TraceReader class constructor.
+ * Nothing can be read until open() is called.
+ */
+TraceReader::TraceReader() {
+    eventsOffset = 0;
+    fileSize = 0;
+    lastTime = -1;
+    keyframeOffset = 0;
+    lastMoveId = -1;
+}
+
+
+/**
+ * @brief Opens a trace.
+ * Reads the header and the starting state, then the keyframe index. If the trace has no index
+ * (the run was cut short), every event is scanned once to find the keyframes and the last time unit.
+ * Afterwards, next() reads from the first event.
+ * @param[in] path The trace file.
+ * @return false if the file could not be opened, or does not start with a trace of this version.
+ */
+bool TraceReader::open(const string& path) {
+    in.close();
+    in.clear();
+    in.open(path.c_str(), ios::binary);
+    if (! in) return false;
+
+    in.seekg(0, ios::end);
+    fileSize = in.tellg();
+    in.seekg(0);
+
+    char magic[sizeof(Trace::MAGIC)];
+    if (! in.read(magic, sizeof(magic)) || memcmp(magic, Trace::MAGIC, sizeof(magic)) != 0) return false;
+
+    uint64_t version;
+    if (! varint::read(in, version) || version != Trace::VERSION) return false;
+
+    if (! start.read(in)) return false;
+    eventsOffset = in.tellg();
+
+    keyframeTimes.clear();
+    keyframeOffsets.clear();
+    if (! readIndex()) {
+        scanIndex();
+    }
+
+    in.clear();
+    in.seekg(eventsOffset);
+    lastMoveId = -1;
+    return true;
+}
+
+
+/**
+ * @brief Gives the state the run started from. Its "currentTime" is the time unit before the first recorded one.
+ * @return The starting state.
+ */
+const Checkpoint& TraceReader::getStart() {
+    return start;
+}
+
+
+/**
+ * @brief Gives the last time unit the trace covers.
+ * @return The time unit of the last TRACE_END_TICK event.
+ */
+int TraceReader::getLastTime() {
+    return lastTime;
+}
+
+
+/**
+ * @brief Jumps to the last keyframe at or before a time unit.
+ * The caller then applies the events read by next() to reach "time" itself. Keyframes are a few dozen time units apart,
+ * so seeking anywhere costs about the same as loading one keyframe and replaying a few dozen time units.
+ * @param[in] time The time unit to seek to.
+ * @param[out] state The keyframe's state, or the starting state if there is no keyframe at or before "time".
+ * @return false if the keyframe could not be read.
+ */
+bool TraceReader::seek(int time, Checkpoint& state) {
+    int k = int(keyframeTimes.size()) - 1;
+    while (k >= 0 && keyframeTimes[k] > time) {
+        k--;
+    }
+
+    in.clear();
+    lastMoveId = -1;
+
+    if (k < 0) {
+        state = start;
+        in.seekg(eventsOffset);
+        return bool(in);
+    }
+
+    in.seekg(keyframeOffsets[k]);
+    uint64_t number;
+    if (! varint::read(in, number) || number != ((uint64_t(TRACE_KEYFRAME) << Trace::TAG_BITS) | TRACE_OTHER)) return false;
+    return readKeyframe(state);
+}
+
+
+/**
+ * @brief Reads and decodes the next event.
+ * Keyframes found along the way are returned as TRACE_KEYFRAME events with their state skipped.
+ * @param[out] event The event.
+ * @return false once the events end: at the index, at the end of the file, or at a cut-off event.
+ */
+bool TraceReader::next(TraceEvent& event) {
+    uint64_t number;
+    if (! varint::read(in, number)) return false;
+
+    event.tag = TraceTag(number & ((1 << Trace::TAG_BITS) - 1));
+    uint64_t payload = number >> Trace::TAG_BITS;
+
+    switch (event.tag) {
+        case TRACE_MOVE: {
+            uint64_t step = payload % (Trace::FAR_STEP+1);
+            event.id = lastMoveId + 1 + int(payload / (Trace::FAR_STEP+1));
+            lastMoveId = event.id;
+
+            if (step == uint64_t(Trace::FAR_STEP)) {
+                return readInt(in, event.rowDelta) && readInt(in, event.colDelta);
+            }
+            event.rowDelta = int(step / Trace::STEP_SPAN) - Trace::MAX_STEP;
+            event.colDelta = int(step % Trace::STEP_SPAN) - Trace::MAX_STEP;
+            return true;
+        }
+        case TRACE_INFECT:
+        case TRACE_HEAL:
+        case TRACE_HURT:
+            event.id = int(payload);
+            return true;
+        case TRACE_ROLE:
+            event.id = int(payload / 4);
+            event.role = AgentRole(payload % 4);
+            return true;
+        case TRACE_PROGRESS:
+            event.id = int(payload / 16);
+            event.progress = (unsigned char)(payload % 16);
+            return true;
+        case TRACE_LANDSCAPE: {
+            event.cell = int(payload);
+            int marker = in.get();
+            event.marker = char(marker);
+            return marker != EOF;
+        }
+        default:
+            break;
+    }
+
+    event.other = TraceOther(payload);
+    switch (event.other) {
+        case TRACE_END_TICK: {
+            uint64_t progressBits;
+            bool ok = readInt(in, event.time) && readInt(in, event.numInfected) && readInt(in, event.cityWallHealth)
+                && varint::read(in, progressBits) && readInt(in, event.scavengersAlive);
+            uint32_t narrowBits = uint32_t(progressBits);
+            memcpy(&event.vaccineResearchProgress, &narrowBits, sizeof(narrowBits));
+            lastMoveId = -1;
+            return ok;
+        }
+        case TRACE_ADD_AGENT: {
+            uint64_t row, col;
+            if (! varint::read(in, row) || ! varint::read(in, col)) return false;
+            int flags = in.get();
+            event.row = int(row);
+            event.col = int(col);
+            event.infected = flags & 1;
+            event.role = AgentRole((flags >> 1) & 3);
+            return flags != EOF;
+        }
+        case TRACE_VACCINE_APPLIED:
+        case TRACE_INFECTION_WORSENED:
+            return true;
+        case TRACE_KEYFRAME:
+            return skipKeyframe();
+        default:
+            //TRACE_INDEX, or something this version does not know: the events are over.
+            return false;
+    }
+}
+
+
+/**
+ * @brief Reads the keyframe index through the trailer at the end of the file.
+ * @return false if the trace has no trailer or the index is damaged.
+ */
+bool TraceReader::readIndex() {
+    in.clear();
+    in.seekg(0, ios::end);
+    streamoff size = in.tellg();
+    if (size < eventsOffset + Trace::INDEX_TRAILER_SIZE) return false;
+
+    unsigned char trailer[Trace::INDEX_TRAILER_SIZE];
+    in.seekg(size - Trace::INDEX_TRAILER_SIZE);
+    if (! in.read((char*)trailer, sizeof(trailer)) || memcmp(trailer+8, Trace::INDEX_MAGIC, sizeof(Trace::INDEX_MAGIC)) != 0) return false;
+
+    uint64_t indexOffset = 0;
+    for (int b=0; b<8; b++) {
+        indexOffset |= uint64_t(trailer[b]) << (8*b);
+    }
+    if (indexOffset < uint64_t(eventsOffset) || indexOffset >= uint64_t(size)) return false;
+
+    in.seekg(indexOffset);
+    uint64_t number, count;
+    if (! varint::read(in, number) || number != ((uint64_t(TRACE_INDEX) << Trace::TAG_BITS) | TRACE_OTHER)) return false;
+    if (! readInt(in, lastTime) || ! varint::read(in, count)) return false;
+
+    int time = 0;
+    uint64_t offset = 0;
+    for (uint64_t k=0; k<count; k++) {
+        int64_t timeDelta;
+        uint64_t offsetDelta;
+        if (! varint::readSigned(in, timeDelta) || ! varint::read(in, offsetDelta)) return false;
+        time += int(timeDelta);
+        offset += offsetDelta;
+        keyframeTimes.push_back(time);
+        keyframeOffsets.push_back(streamoff(offset));
+    }
+    return true;
+}
+
+
+/**
+ * @brief Builds the keyframe index of a trace that has none by reading every event.
+ * Everything up to the first damaged or missing event is usable.
+ */
+void TraceReader::scanIndex() {
+    keyframeTimes.clear();
+    keyframeOffsets.clear();
+    lastTime = start.currentTime;
+
+    in.clear();
+    in.seekg(eventsOffset);
+    lastMoveId = -1;
+
+    //A keyframe is at the time unit of the TRACE_END_TICK before it.
+    TraceEvent event;
+    while (next(event)) {
+        if (event.tag == TRACE_OTHER && event.other == TRACE_END_TICK) {
+            lastTime = event.time;
+        }
+        else if (event.tag == TRACE_OTHER && event.other == TRACE_KEYFRAME) {
+            keyframeTimes.push_back(lastTime);
+            keyframeOffsets.push_back(keyframeOffset);
+        }
+    }
+}
+
+
+/**
+ * @brief Reads the state of a keyframe event, just after its event number.
+ * @param[out] state Where to put the state.
+ * @return false if the keyframe is damaged or cut short.
+ */
+bool TraceReader::readKeyframe(Checkpoint& state) {
+    uint64_t length;
+    if (! varint::read(in, length)) return false;
+    return state.read(in);
+}
+
+
+/**
+ * @brief Skips the state of a keyframe event, just after its event number, and remembers where the event started in "keyframeOffset".
+ * @return false if the keyframe is cut short, so scanIndex() never indexes a keyframe that seek() cannot read.
+ */
+bool TraceReader::skipKeyframe() {
+    //The event number of a keyframe always takes one byte.
+    keyframeOffset = streamoff(in.tellg()) - 1;
+
+    uint64_t length;
+    if (! varint::read(in, length)) return false;
+
+    //Seeking past the end does not fail a file stream, so check that the whole keyframe is there.
+    streamoff keyframeEnd = streamoff(in.tellg());
+    if (length > uint64_t(fileSize - keyframeEnd)) {
+        in.setstate(ios::failbit);
+        return false;
+    }
+    in.seekg(keyframeEnd + streamoff(length));
+    return bool(in);
+}
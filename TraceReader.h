@@ -0,0 +1,99 @@
+/**
+ * @file TraceReader.h
+ * @brief The TraceReader class declaration file.
+ */
+
+#ifndef TRACEREADER_H
+#define TRACEREADER_H
+
+#include <stdint.h>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "Checkpoint.h"
+#include "Trace.h"
+
+using namespace std;
+
+/**
+ * @brief One decoded trace event. Only the fields that the event's kind uses are set.
+ */
+struct TraceEvent {
+    TraceTag tag;                   // Kind of event
+    TraceOther other;               // Kind of TRACE_OTHER event
+    int id;                         // Agent id (TRACE_MOVE, TRACE_INFECT, TRACE_HEAL, TRACE_HURT, TRACE_ROLE, TRACE_PROGRESS)
+    int rowDelta;                   // Rows moved (TRACE_MOVE)
+    int colDelta;                   // Columns moved (TRACE_MOVE)
+    AgentRole role;                 // New role (TRACE_ROLE, TRACE_ADD_AGENT)
+    unsigned char progress;         // New ScavengerProgress bits (TRACE_PROGRESS)
+    int cell;                       // Row-major cell index (TRACE_LANDSCAPE)
+    char marker;                    // New landscape marker (TRACE_LANDSCAPE)
+    int row;                        // Row of the new agent (TRACE_ADD_AGENT)
+    int col;                        // Column of the new agent (TRACE_ADD_AGENT)
+    bool infected;                  // Whether the new agent is infected (TRACE_ADD_AGENT)
+    int time;                       // Time unit completed (TRACE_END_TICK)
+    int numInfected;                // Statistics at the end of the time unit (TRACE_END_TICK)
+    int cityWallHealth;
+    float vaccineResearchProgress;
+    int scavengersAlive;
+};
+
+/**
+ * @class TraceReader
+ * @brief Reads a trace written by Trace, and seeks in it using its keyframes.
+ * The keyframe index is read from the end of the file. A trace that was cut short has no index,
+ * so its events are scanned once on open() instead.
+ */
+class TraceReader {
+    public:
+    TraceReader();
+
+    //Open a trace and find its keyframes. Returns false if the file is not a trace of this version.
+    bool open(const string& path);
+
+    //The state the run started from, and the last time unit the trace covers.
+    const Checkpoint& getStart();
+    int getLastTime();
+
+    //Load the last keyframe at or before time unit "time" into "state", and continue reading the events after it.
+    //"state.currentTime" tells which time unit the keyframe is at.
+    bool seek(int time, Checkpoint& state);
+
+    //Read the next event. Returns false at the end of the events, or if the trace is cut short.
+    bool next(TraceEvent& event);
+
+
+    protected:
+    //Read the index from the trailer, or build it by scanning every event.
+    bool readIndex();
+    void scanIndex();
+
+    //Read a keyframe event's Checkpoint, or skip past it.
+    bool readKeyframe(Checkpoint& state);
+    bool skipKeyframe();
+
+    ifstream in;
+
+    //Size of the open file, so skipped keyframes can be checked against it.
+    streamoff fileSize;
+
+    //The starting state, and the offset of the first event after it.
+    Checkpoint start;
+    streamoff eventsOffset;
+
+    //Last time unit covered by the trace.
+    int lastTime;
+
+    //Time unit and file offset of each keyframe, in order.
+    vector<int> keyframeTimes;
+    vector<streamoff> keyframeOffsets;
+
+    //Offset of the keyframe event most recently skipped by next().
+    streamoff keyframeOffset;
+
+    //Agent id of the last move read in the current time unit.
+    int lastMoveId;
+};
+
+#endif // TRACEREADER_H
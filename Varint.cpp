@@ -0,0 +1,83 @@
+/**
+ * @file Varint.cpp
+ * @brief Variable-length integer encoding used by the binary file formats.
+ */
+
+#include "Varint.h"
+
+using namespace std;
+
+namespace varint {
+
+    /** @brief Encodes an unsigned number into memory.
+     * @param value The number.
+     * @param bytes Where to put the encoding. Needs room for MAX_LENGTH bytes.
+     * @return The number of bytes used.
+     */
+    int encode( uint64_t value, char* bytes ) {
+	int length = 0;
+
+	while( value >= 0x80 ) {
+	    bytes[length++] = char( (value & 0x7f) | 0x80 );
+	    value >>= 7;
+	}
+	bytes[length++] = char( value );
+
+	return length;
+    }
+
+    /** @brief Maps a signed number to an unsigned one, so small negative numbers stay small.
+     * @param value The number.
+     * @return 0, 1, 2, 3, ... for 0, -1, 1, -2, ...
+     */
+    uint64_t zigzag( int64_t value ) {
+	return (uint64_t( value ) << 1) ^ uint64_t( value >> 63 );
+    }
+
+    /** @brief Writes an unsigned number.
+     * @param out The binary stream to write to.
+     * @param value The number.
+     */
+    void write( ostream& out, uint64_t value ) {
+	char bytes[MAX_LENGTH];
+	out.write( bytes, encode( value, bytes ) );
+    }
+
+    /** @brief Writes a signed number, zigzag-mapped.
+     * @param out The binary stream to write to.
+     * @param value The number.
+     */
+    void writeSigned( ostream& out, int64_t value ) {
+	write( out, zigzag( value ) );
+    }
+
+    /** @brief Reads an unsigned number written by write().
+     * @param in The binary stream to read from.
+     * @param value Where to put the number.
+     * @return false if the stream ended or failed, or the number was too long.
+     */
+    bool read( istream& in, uint64_t& value ) {
+	value = 0;
+	for( int shift=0; shift<7*MAX_LENGTH; shift+=7 ) {
+	    int byte = in.get();
+	    if( byte == EOF ) return false;
+
+	    value |= uint64_t( byte & 0x7f ) << shift;
+	    if( (byte & 0x80) == 0 ) return true;
+	}
+	return false;
+    }
+
+    /** @brief Reads a signed number written by writeSigned().
+     * @param in The binary stream to read from.
+     * @param value Where to put the number.
+     * @return false if the stream ended or failed, or the number was too long.
+     */
+    bool readSigned( istream& in, int64_t& value ) {
+	uint64_t zigzag;
+	if( ! read( in, zigzag ) ) return false;
+
+	value = int64_t( zigzag >> 1 ) ^ -int64_t( zigzag & 1 );
+	return true;
+    }
+}
@@ -0,0 +1,37 @@
+/**
+ * @file Varint.h
+ * @brief Variable-length integer encoding used by the binary file formats.
+ */
+
+#ifndef VARINT_H
+#define VARINT_H
+
+#include <stdint.h>
+#include <iostream>
+
+using namespace std;
+
+/**
+ * @brief Little-endian base-128 integers: 7 bits per byte, with the top bit set on every byte but the last.
+ * Small numbers take one byte. Signed numbers are zigzag-mapped first (0, -1, 1, -2, ... become 0, 1, 2, 3, ...),
+ * so small negative numbers stay small too.
+ */
+namespace varint {
+    //The most bytes one encoded number can take.
+    const int MAX_LENGTH = 10;
+
+    //Encode into "bytes", which must have room for MAX_LENGTH bytes, and return the number of bytes used.
+    int encode( uint64_t value, char* bytes );
+
+    //Zigzag mapping of a signed number, for encode().
+    uint64_t zigzag( int64_t value );
+
+    void write( ostream& out, uint64_t value );
+    void writeSigned( ostream& out, int64_t value );
+
+    //Return false if the stream ends or fails before a whole number was read.
+    bool read( istream& in, uint64_t& value );
+    bool readSigned( istream& in, int64_t& value );
+}
+
+#endif // VARINT_H
@@ -0,0 +1,140 @@
+/**
+ * @file WorkerPool.cpp
+ * @brief The WorkerPool class implementation file.
+ */
+
+#include "WorkerPool.h"
+
+using namespace std;
+
+
+/**
+ * @brief The WorkerPool class constructor.
+ * The pool starts with no threads of its own, so loops run entirely on the caller until start() is called.
+ */
+WorkerPool::WorkerPool() : nextItem(0) {
+    body = NULL;
+    count = 0;
+    rangeSize = 0;
+    loopNumber = 0;
+    busyThreads = 0;
+    stopping = false;
+}
+
+
+/**
+ * @brief The WorkerPool class destructor.
+ * Tells the pool threads to finish and waits for them.
+ */
+WorkerPool::~WorkerPool() {
+    {
+        lock_guard<mutex> guard(lock);
+        stopping = true;
+    }
+    loopReady.notify_all();
+
+    for (size_t i=0; i<threads.size(); i++) {
+        threads[i].join();
+    }
+}
+
+
+/**
+ * @brief Starts the pool threads.
+ * Only meant to be called once, before the first loop.
+ * @param[in] numThreads Threads loops should run on, including the caller. 1 or less runs every loop on the caller.
+ */
+void WorkerPool::start(int numThreads) {
+    for (int i=1; i<numThreads; i++) {
+        threads.push_back(thread(&WorkerPool::worker, this));
+    }
+}
+
+
+/**
+ * @brief Reports how many threads loops run on.
+ * @return The pool threads plus the caller.
+ */
+int WorkerPool::size() {
+    return threads.size() + 1;
+}
+
+
+/**
+ * @brief Runs a loop over "numItems" items on the pool.
+ * The items are cut into ranges, and each thread repeatedly claims the next range and calls body(begin, end) on it.
+ * Which thread runs which range varies from call to call, so the body must give the same result no matter how the items are split.
+ * Small loops run entirely on the caller.
+ * @param[in] numItems The number of items.
+ * @param[in] loopBody Function called with the start and one-past-the-end item of each range.
+ */
+void WorkerPool::parallelFor(int numItems, const function<void(int, int)>& loopBody) {
+    if (threads.empty() || numItems < 2*MIN_RANGE) {
+        if (numItems > 0) loopBody(0, numItems);
+        return;
+    }
+
+    //Hand out several ranges per thread, so threads that finish early can take over remaining work.
+    {
+        lock_guard<mutex> guard(lock);
+        body = &loopBody;
+        count = numItems;
+        rangeSize = numItems / (size()*8);
+        if (rangeSize < MIN_RANGE) rangeSize = MIN_RANGE;
+        nextItem = 0;
+        busyThreads = threads.size();
+        loopNumber++;
+    }
+    loopReady.notify_all();
+
+    runRanges();
+
+    //Wait for the pool threads to finish their last ranges.
+    unique_lock<mutex> guard(lock);
+    while (busyThreads > 0) {
+        loopDone.wait(guard);
+    }
+    body = NULL;
+}
+
+
+/**
+ * @brief The loop each pool thread runs until the pool is destroyed.
+ */
+void WorkerPool::worker() {
+    int lastLoop = 0;
+
+    while (true) {
+        {
+            unique_lock<mutex> guard(lock);
+            while (! stopping && loopNumber == lastLoop) {
+                loopReady.wait(guard);
+            }
+            if (stopping) return;
+            lastLoop = loopNumber;
+        }
+
+        runRanges();
+
+        {
+            lock_guard<mutex> guard(lock);
+            busyThreads--;
+        }
+        loopDone.notify_one();
+    }
+}
+
+
+/**
+ * @brief Claims ranges of the current loop and runs them until every item has been claimed.
+ */
+void WorkerPool::runRanges() {
+    while (true) {
+        int begin = nextItem.fetch_add(rangeSize);
+        if (begin >= count) return;
+
+        int end = begin + rangeSize;
+        if (end > count) end = count;
+        (*body)(begin, end);
+    }
+}
@@ -0,0 +1,72 @@
+/**
+ * @file WorkerPool.h
+ * @brief The WorkerPool class declaration file.
+ */
+
+#ifndef WORKERPOOL_H
+#define WORKERPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+/**
+ * @class WorkerPool
+ * @brief A fixed set of threads that split loops over many items between them.
+ * The threads are started once and wait between loops, so a loop can be run in parallel every time unit without
+ * the cost of starting threads. The calling thread works on the loop too.
+ */
+class WorkerPool {
+    public:
+    WorkerPool();
+    ~WorkerPool();
+
+    //Start the pool so loops run on "numThreads" threads in total, including the caller.
+    void start(int numThreads);
+
+    //Number of threads loops run on, including the caller.
+    int size();
+
+    //Call body(begin, end) on consecutive ranges covering [0, numItems), spread over the pool. Returns once every range is done.
+    void parallelFor(int numItems, const function<void(int, int)>& body);
+
+
+    protected:
+    //Loop run by each pool thread: wait for a loop, help with it, and wait again.
+    void worker();
+
+    //Claim ranges of the current loop and run them until none are left.
+    void runRanges();
+
+    //Fewest items worth handing to another thread.
+    static const int MIN_RANGE = 1024;
+
+    vector<thread> threads;
+
+    //Guards everything below except "nextItem".
+    mutex lock;
+    condition_variable loopReady;
+    condition_variable loopDone;
+
+    //The current loop: its body, item count, range size, and the first item not yet claimed.
+    const function<void(int, int)>* body;
+    int count;
+    int rangeSize;
+    atomic<int> nextItem;
+
+    //Bumped for each loop so waiting threads can tell a new loop has started.
+    int loopNumber;
+
+    //Pool threads still working on the current loop.
+    int busyThreads;
+
+    //Set by the destructor to let the threads finish.
+    bool stopping;
+};
+
+#endif // WORKERPOOL_H
@@ -39,9 +39,53 @@ namespace conio {
      * gotoRowCol = CSI r;c
      */
     string gotoRowCol( const int row, const int col ) {
-	std::ostringstream strm;		// create the string stream
-	strm << CSI << row << ';' << col << 'H';	// insert the goodies
-	return strm.str();			// return a string with the info
+	char buffer[MAX_ROW_COL_LENGTH];
+	return string( buffer, writeRowCol( buffer, row, col ) );
+    }
+
+    /** @brief Writes the decimal digits of a number into a buffer.
+     * @param buffer Where to write. Must have room for 11 characters.
+     * @param value The number to write.
+     * @return The number of characters written.
+     */
+    static int writeInt( char* buffer, int value ) {
+	char digits[12];
+	int count = 0;
+	int length = 0;
+	unsigned int magnitude = value;
+
+	if( value < 0 ) {
+	    buffer[length++] = '-';
+	    magnitude = 0u - magnitude;
+	}
+	do {
+	    digits[count++] = char( '0' + magnitude % 10 );
+	    magnitude /= 10;
+	} while( magnitude > 0 );
+
+	while( count > 0 ) buffer[length++] = digits[--count];
+	return length;
+    }
+
+    /** @brief Writes the escape sequence that positions the cursor into a caller-supplied buffer.
+     *
+     * Same sequence as gotoRowCol(), but formatted directly into "buffer" without
+     * using the heap. The sequence is not null-terminated.
+     *
+     * @param buffer Where to write. Must have room for MAX_ROW_COL_LENGTH characters.
+     * @param row The row coordinate (1-based).
+     * @param col The column coordinate (1-based).
+     * @return The number of characters written.
+     */
+    int writeRowCol( char* buffer, const int row, const int col ) {
+	int length = 0;
+	buffer[length++] = CSI[0];
+	buffer[length++] = CSI[1];
+	length += writeInt( buffer+length, row );
+	buffer[length++] = ';';
+	length += writeInt( buffer+length, col );
+	buffer[length++] = 'H';
+	return length;
     }
 
     const int Foreground = 1;	// local implementation-specific values
@@ -100,6 +144,84 @@ namespace conio {
 	return getColorSequence( c, Background );	// insert the goodies
     }
 
+    /** @brief Returns the precomputed escape sequence that sets the foreground color.
+     * Same sequence as fgColor(), without building a string.
+     * @param c The Color value to use for the text foreground color.
+     * @return A constant C-string, or an empty one for an invalid color.
+     */
+    const char* fgColorSequence( Color c ) {
+	switch( c ) {
+	    case BLACK:		return "\033[30m";
+	    case RED:		return "\033[31m";
+	    case GREEN:		return "\033[32m";
+	    case YELLOW:	return "\033[33m";
+	    case BLUE:		return "\033[34m";
+	    case MAGENTA:	return "\033[35m";
+	    case CYAN:		return "\033[36m";
+	    case LIGHT_GRAY:	return "\033[37m";
+	    case RESET:		return "\033[39m";
+	    case GRAY:		return "\033[90m";
+	    case LIGHT_RED:	return "\033[91m";
+	    case LIGHT_GREEN:	return "\033[92m";
+	    case LIGHT_YELLOW:	return "\033[93m";
+	    case LIGHT_BLUE:	return "\033[94m";
+	    case LIGHT_MAGENTA:	return "\033[95m";
+	    case LIGHT_CYAN:	return "\033[96m";
+	    case WHITE:		return "\033[97m";
+	    default:		return "";
+	}
+    }
+
+    /** @brief Returns the precomputed escape sequence that sets the background color.
+     * Same sequence as bgColor(), without building a string.
+     * @param c The Color value to use for the text background color.
+     * @return A constant C-string, or an empty one for an invalid color.
+     */
+    const char* bgColorSequence( Color c ) {
+	switch( c ) {
+	    case BLACK:		return "\033[40m";
+	    case RED:		return "\033[41m";
+	    case GREEN:		return "\033[42m";
+	    case YELLOW:	return "\033[43m";
+	    case BLUE:		return "\033[44m";
+	    case MAGENTA:	return "\033[45m";
+	    case CYAN:		return "\033[46m";
+	    case LIGHT_GRAY:	return "\033[47m";
+	    case RESET:		return "\033[49m";
+	    case GRAY:		return "\033[100m";
+	    case LIGHT_RED:	return "\033[101m";
+	    case LIGHT_GREEN:	return "\033[102m";
+	    case LIGHT_YELLOW:	return "\033[103m";
+	    case LIGHT_BLUE:	return "\033[104m";
+	    case LIGHT_MAGENTA:	return "\033[105m";
+	    case LIGHT_CYAN:	return "\033[106m";
+	    case WHITE:		return "\033[107m";
+	    default:		return "";
+	}
+    }
+
+    /** @brief Returns the precomputed escape sequence that sets the text style.
+     * Same sequence as setTextStyle(), without building a string.
+     * @param ts The TextStyle value to use for the text style.
+     * @return A constant C-string, or an empty one for an invalid style.
+     */
+    const char* textStyleSequence( TextStyle ts ) {
+	switch( ts ) {
+	    case BOLD:			return "\033[1m";
+	    case FAINT:			return "\033[2m";
+	    case ITALIC:		return "\033[3m";
+	    case UNDERLINE:		return "\033[4m";
+	    case SLOW_BLINK:		return "\033[5m";
+	    case RAPID_BLINK:		return "\033[6m";
+	    case NEGATIVE_IMAGE:	return "\033[7m";
+	    case CONCEAL:		return "\033[8m";
+	    case DOUBLE_UNDERLINE:	return "\033[21m";
+	    case NORMAL_INTENSITY:	return "\033[22m";
+	    case REVEAL:		return "\033[28m";
+	    default:			return "";
+	}
+    }
+
     /** @brief Returns a string that contains the escape sequence to set the
      * text style to the specified TextStyle.
      * @param ts The TextStyle valoue to use for the text style.
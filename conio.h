@@ -46,12 +46,30 @@ namespace conio {
      */
     const char CSI[] = {'\033', '[', '\0'};
 
+    /**
+     * @brief Escape sequences that never change, as ready-made C-strings.
+     * RESET_ALL matches resetAll() and CLEAR_SCREEN matches clrscr().
+     */
+    const char RESET_ALL[] = "\033[0m";
+    const char CLEAR_SCREEN[] = "\033[2J";
+
+    /**
+     * @brief The most characters writeRowCol() can write, for sizing buffers.
+     */
+    const int MAX_ROW_COL_LENGTH = 32;
+
     string gotoRowCol( const int x, const int y );
     string fgColor( Color c );
     string bgColor( Color c );
     string setTextStyle( TextStyle ts );
     string resetAll( );
     string clrscr();
+
+    // Allocation-free versions of the functions above. These never use the heap.
+    int writeRowCol( char* buffer, const int row, const int col );
+    const char* fgColorSequence( Color c );
+    const char* bgColorSequence( Color c );
+    const char* textStyleSequence( TextStyle ts );
 }
 
 #endif		// ifdef CONIO_H
@@ -9,31 +9,321 @@
 
 #include <iostream>
 #include <cstdlib>
+#include <cstring>
+#include <string>
 #include <time.h>
+#include <thread>
 
 #include "Board.h"
+#include "Checkpoint.h"
+#include "DensityBoard.h"
+#include "Ensemble.h"
+#include "TraceReader.h"
 
 using namespace std;
 
+/**
+ * @brief Prints how to run the program.
+ * @param[in] program The name the program was run as.
+ */
+void printUsage(const char* program) {
+    cerr << "Usage: " << program << " [--headless] [--density] [--runs N [--threads N]] [--rows N] [--cols N] [--humans N] [--doctors N] [--scavengers N] [--ticks N] [--seed N] [--checkpoint FILE [--checkpoint-every N]] [--restore FILE] [--trace FILE [--keyframe-every N]] [--replay FILE [--from N] [--to N] [--speed N]] [--move-threads N] [--bitboard-infection] [--tick-delay N] [--fps N]" << endl
+         << "  --headless   Skip all drawing and sleeping, stop as soon as the outcome is settled, and print a JSON summary." << endl
+         << "  --density    Track how many healthy, infected, and doctor people are on each cell instead of individual humans, and print a JSON summary." << endl
+         << "               Always headless; for boards and populations far too large to simulate one human at a time." << endl
+         << "  --runs N     Play N headless games, each on its own random stream, and print aggregated JSON results." << endl
+         << "  --threads N  Threads used by --runs (default: one per core)." << endl
+         << "  --rows N     Rows in the board (default 20, at least " << Board::MIN_ROWS << ")." << endl
+         << "  --cols N     Columns in the board (default 80, at least " << Board::MIN_COLS << ")." << endl
+         << "  --humans N   Total humans, including doctors (default 18)." << endl
+         << "  --doctors N  Doctors, fewer than a third of the humans (default 2)." << endl
+         << "  --scavengers N  Scavengers racing for the vaccine ingredients (default 1)." << endl
+         << "  --ticks N    Last time unit to simulate (default 400)." << endl
+         << "  --seed N     Random seed (default: the current time)." << endl
+         << "  --checkpoint FILE     Save the run to FILE every --checkpoint-every time units (default 50)." << endl
+         << "  --trace FILE  Record every event of the run to FILE, in a compact binary format, with a keyframe every --keyframe-every time units (default 50)." << endl
+         << "  --replay FILE  Play back the run recorded in FILE, from time unit --from to --to (default: all of it), --speed time units per frame (default 1, negative for backward)." << endl
+         << "               With --headless, print the summary of the run as it was at --to instead." << endl
+         << "  --restore FILE  Continue the run saved in FILE. The scenario, movement and infection rules, and seed come from the file; --ticks may still be given," << endl
+         << "               and --move-threads as long as it keeps the movement rule." << endl
+         << "  --move-threads N  Move all humans at once, settling conflicts by priority, on N threads. The game only depends on the seed, not N." << endl
+         << "  --bitboard-infection  Infect and heal everyone at once, from where everyone stood at the start of the time unit, 64 cells at a time." << endl
+         << "               Much faster on crowded boards, but a different game from the default rule for the same seed." << endl
+         << "  --tick-delay N  Microseconds the simulation waits after each time unit (default 250000, 0 for full speed)." << endl
+         << "  --fps N      Frames shown per second, independent of the simulation speed (default 30)." << endl;
+}
+
+
+/**
+ * @brief Prints the end-of-run summary as one line of JSON.
+ * @param[in] summary The summary returned by Board::getSummary().
+ * @param[in] seed The seed the run used.
+ */
+void printSummary(const RunSummary& summary, uint64_t seed) {
+    cout << "{\"outcome\":\"" << outcomeName(summary.outcome) << "\""
+         << ",\"reason\":\"" << reasonName(summary.reason) << "\""
+         << ",\"decidedTick\":" << summary.decidedTick
+         << ",\"endTick\":" << summary.endTick
+         << ",\"humans\":" << summary.numHumans
+         << ",\"infected\":" << summary.numInfected
+         << ",\"vaccineProgress\":" << summary.vaccineResearchProgress
+         << ",\"cityWallHealth\":" << summary.cityWallHealth
+         << ",\"seed\":" << seed
+         << "}" << endl;
+}
+
+
 /**
  * @fn main()
  * @brief Main function that starts the simulation running.
  * The main function does the following:
- * (1) seeds the random number generator
- * (2) creates a board object that is 20 rows by 80 columns and contains 18 total humans with 2 of those being doctors.
- * (3) starts the simulation running by calling the board's run function.
+ * (1) reads the scenario parameters from the command line (by default, 20 rows by 80 columns with 18 total humans, 2 of those being doctors)
+ * (2) creates a board object for the scenario.
+ * (3) seeds the board's random number generator, or restores a checkpointed run
+ * (4) starts the simulation running by calling the board's run function.
+ * (5) in headless mode, prints a machine-readable summary of the run.
+ * With --runs, an Ensemble plays many headless games across threads instead, and prints aggregated results.
+ * With --density, a DensityBoard plays the game on per-cell population densities instead.
  **/
-int main() {
+int main(int argc, char* argv[]) {
+    bool headless = false;
+    bool density = false;
+    int rows = 20;
+    int cols = 80;
+    int numHumans = 18;
+    int numDoctors = 2;
+    int numScavengers = 1;
+    int ticks = 400;
+    uint64_t seed = time(NULL);
+    int runs = 0;
+    int threads = thread::hardware_concurrency();
+    int moveThreads = 0;
+    bool moveThreadsGiven = false;
+    bool bitboardInfection = false;
+    string checkpointPath;
+    int checkpointEvery = 50;
+    string restorePath;
+    string tracePath;
+    int keyframeEvery = 50;
+    string replayPath;
+    int replayFrom = -1;
+    int replayTo = -1;
+    bool replayToGiven = false;
+    int replaySpeed = 1;
+    bool ticksGiven = false;
+    int tickDelay = 250000;
+    int framesPerSecond = 30;
+
+    //Read the command line.
+    for (int i=1; i<argc; i++) {
+        if (strcmp(argv[i], "--headless") == 0) {
+            headless = true;
+        }
+        else if (strcmp(argv[i], "--density") == 0) {
+            density = true;
+        }
+        else if (i+1 < argc && strcmp(argv[i], "--rows") == 0) {
+            rows = atoi(argv[++i]);
+        }
+        else if (i+1 < argc && strcmp(argv[i], "--cols") == 0) {
+            cols = atoi(argv[++i]);
+        }
+        else if (i+1 < argc && strcmp(argv[i], "--humans") == 0) {
+            numHumans = atoi(argv[++i]);
+        }
+        else if (i+1 < argc && strcmp(argv[i], "--doctors") == 0) {
+            numDoctors = atoi(argv[++i]);
+        }
+        else if (i+1 < argc && strcmp(argv[i], "--scavengers") == 0) {
+            numScavengers = atoi(argv[++i]);
+        }
+        else if (i+1 < argc && strcmp(argv[i], "--ticks") == 0) {
+            ticks = atoi(argv[++i]);
+            ticksGiven = true;
+        }
+        else if (i+1 < argc && strcmp(argv[i], "--seed") == 0) {
+            seed = strtoull(argv[++i], NULL, 10);
+        }
+        else if (i+1 < argc && strcmp(argv[i], "--runs") == 0) {
+            runs = atoi(argv[++i]);
+        }
+        else if (i+1 < argc && strcmp(argv[i], "--threads") == 0) {
+            threads = atoi(argv[++i]);
+        }
+        else if (i+1 < argc && strcmp(argv[i], "--checkpoint") == 0) {
+            checkpointPath = argv[++i];
+        }
+        else if (i+1 < argc && strcmp(argv[i], "--checkpoint-every") == 0) {
+            checkpointEvery = atoi(argv[++i]);
+        }
+        else if (i+1 < argc && strcmp(argv[i], "--restore") == 0) {
+            restorePath = argv[++i];
+        }
+        else if (i+1 < argc && strcmp(argv[i], "--trace") == 0) {
+            tracePath = argv[++i];
+        }
+        else if (i+1 < argc && strcmp(argv[i], "--keyframe-every") == 0) {
+            keyframeEvery = atoi(argv[++i]);
+        }
+        else if (i+1 < argc && strcmp(argv[i], "--replay") == 0) {
+            replayPath = argv[++i];
+        }
+        else if (i+1 < argc && strcmp(argv[i], "--from") == 0) {
+            replayFrom = atoi(argv[++i]);
+        }
+        else if (i+1 < argc && strcmp(argv[i], "--to") == 0) {
+            replayTo = atoi(argv[++i]);
+            replayToGiven = true;
+        }
+        else if (i+1 < argc && strcmp(argv[i], "--speed") == 0) {
+            replaySpeed = atoi(argv[++i]);
+        }
+        else if (i+1 < argc && strcmp(argv[i], "--move-threads") == 0) {
+            moveThreads = atoi(argv[++i]);
+            moveThreadsGiven = true;
+        }
+        else if (strcmp(argv[i], "--bitboard-infection") == 0) {
+            bitboardInfection = true;
+        }
+        else if (i+1 < argc && strcmp(argv[i], "--tick-delay") == 0) {
+            tickDelay = atoi(argv[++i]);
+        }
+        else if (i+1 < argc && strcmp(argv[i], "--fps") == 0) {
+            framesPerSecond = atoi(argv[++i]);
+        }
+        else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    //The landscape needs room for the city wall and research facility, and the city needs at least one regular human.
+    if (rows < Board::MIN_ROWS || cols < Board::MIN_COLS || numDoctors < 0 || numHumans/3 <= numDoctors || numScavengers < 0 || ticks < 0 || runs < 0 || moveThreads < 0 || checkpointEvery <= 0 || keyframeEvery < 0 || replaySpeed == 0 || tickDelay < 0 || framesPerSecond <= 0) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    //Density boards have no agents to checkpoint, trace, or replay, and play a single game.
+    if (density && (runs > 0 || ! checkpointPath.empty() || ! restorePath.empty() || ! tracePath.empty() || ! replayPath.empty())) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    //Play one game on densities.
+    if (density) {
+        DensityBoard board(rows, cols, numHumans, numDoctors);
+        board.setSeed(seed);
+        board.setTickLimit(ticks);
+        board.run();
+        printSummary(board.getSummary(), seed);
+        return 0;
+    }
 
-    //Seed the random number generator.
-    srand( time(NULL) );
+    //Play a whole ensemble of games.
+    if (runs > 0) {
+        Ensemble ensemble(rows, cols, numHumans, numDoctors, numScavengers, ticks);
+        ensemble.run(runs, threads, seed);
+        ensemble.printReport(cout);
+        return 0;
+    }
+
+    //Play back a recorded run.
+    if (! replayPath.empty()) {
+        TraceReader reader;
+        if (! reader.open(replayPath)) {
+            cerr << "Could not read trace " << replayPath << endl;
+            return 1;
+        }
+
+        //Stay within the time units the trace covers.
+        int first = reader.getStart().currentTime;
+        int last = reader.getLastTime();
+        if (! replayToGiven) {
+            replayTo = (replaySpeed > 0) ? last : first;
+        }
+        if (replaySpeed < 0 && replayFrom == -1) {
+            replayFrom = last;
+        }
+        replayFrom = (replayFrom < first) ? first : (replayFrom > last) ? last : replayFrom;
+        replayTo = (replayTo < first) ? first : (replayTo > last) ? last : replayTo;
+
+        const Checkpoint& start = reader.getStart();
+        Board board(start.numRows, start.numCols, start.numHumans, start.numDoctors);
+        board.setHeadless(headless);
+        board.setTickDelay(tickDelay);
+        board.setFrameRate(framesPerSecond);
+        board.replay(reader, replayFrom, replayTo, replaySpeed);
+
+        //The seed the recorded run started from, not this one's.
+        if (headless) {
+            printSummary(board.getSummary(), start.seed);
+        }
+        return 0;
+    }
+
+    //A restored run takes its scenario from the checkpoint.
+    Checkpoint checkpoint;
+    if (! restorePath.empty()) {
+        if (! checkpoint.load(restorePath)) {
+            cerr << "Could not read checkpoint " << restorePath << endl;
+            return 1;
+        }
+        rows = checkpoint.numRows;
+        cols = checkpoint.numCols;
+        numHumans = checkpoint.numHumans;
+        numDoctors = checkpoint.numDoctors;
+        seed = checkpoint.seed;
+
+        //So does the movement rule. --move-threads may only choose how many threads play it.
+        if (moveThreadsGiven && (moveThreads > 0) != checkpoint.movesAtOnce) {
+            cerr << "Checkpoint " << restorePath << (checkpoint.movesAtOnce ? " moves all humans at once; --move-threads must be at least 1" : " moves humans one after another; --move-threads must be 0") << endl;
+            return 1;
+        }
+        if (checkpoint.movesAtOnce && ! moveThreadsGiven) {
+            moveThreads = (threads > 0) ? threads : 1;
+        }
+
+        //And the infection rule, which --bitboard-infection cannot switch either.
+        if (bitboardInfection && ! checkpoint.bitboardInfection) {
+            cerr << "Checkpoint " << restorePath << " infects one adjacent pair after another; --bitboard-infection cannot be used with it" << endl;
+            return 1;
+        }
+    }
 
     //Parameters: rows, cols, numHumans, numDoctors.
-    Board board(20, 80, 18, 2);
+    Board board(rows, cols, numHumans, numDoctors);
+    board.setHeadless(headless);
+    board.setMoveThreads(moveThreads);
+    board.setBitboardInfection(bitboardInfection);
+    board.setTickDelay(tickDelay);
+    board.setFrameRate(framesPerSecond);
+
+    //Seed the board's random number generator, or continue exactly where the checkpoint left off.
+    if (restorePath.empty()) {
+        board.setSeed(seed);
+        board.setNumScavengers(numScavengers);
+        board.setTickLimit(ticks);
+    }
+    else {
+        board.restoreCheckpoint(checkpoint);
+        if (ticksGiven) {
+            board.setTickLimit(ticks);
+        }
+    }
+
+    if (! checkpointPath.empty()) {
+        board.setCheckpointFile(checkpointPath, checkpointEvery);
+    }
+
+    board.setTraceFile(tracePath, keyframeEvery);
 
     //Run the simulation.
     board.run();
 
+    //Report how the run ended.
+    if (headless) {
+        printSummary(board.getSummary(), seed);
+    }
+
     return 0;
 }
-